@@ -38,8 +38,15 @@ using namespace std;
 #define FTY_INFO_CMD    "INFO"
 #define DEFAULT_PATH    "/api/v1/admin/info"
 #define DEFAULT_ANNOUNCE_INTERVAL_SEC   60
+#define STR_DEFAULT_ANNOUNCE_INTERVAL_SEC   "60"
 #define DEFAULT_LINUXMETRICS_INTERVAL_SEC   30
 #define STR_DEFAULT_LINUXMETRICS_INTERVAL_SEC   "30"
+#define DEFAULT_ANNOUNCE_QUIET_MS       500
+#define STR_DEFAULT_ANNOUNCE_QUIET_MS   "500"
+#define DEFAULT_ANNOUNCE_MAX_DELAY_MS       5000
+#define STR_DEFAULT_ANNOUNCE_MAX_DELAY_MS   "5000"
+#define DEFAULT_TOPOLOGY_CACHE_SIZE     1000
+#define STR_DEFAULT_TOPOLOGY_CACHE_SIZE "1000"
 
 // TODO: get from config
 #define TIMEOUT_MS              -1   //wait infinitely
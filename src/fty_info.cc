@@ -31,11 +31,89 @@
 #define RC0_RUNONCE_ACTOR "fty-info-rc0-runonce"
 #define DEFAULT_LOG_CONFIG "/etc/fty/ftylog.cfg"
 
-static int
-s_linuxmetrics_event (zloop_t *loop, int timer_id, void *output)
+//  Return true if value of key differs in config and previous one, or if
+//  there is no previous config
+static bool
+s_changed (zconfig_t *config, zconfig_t *previous, const char *key)
 {
-    zstr_send (output, "LINUXMETRICS");
-    return 0;
+    if (!previous)
+        return true;
+    const char *value = s_get (config, key, NULL);
+    const char *previous_value = s_get (previous, key, NULL);
+    if (!value || !previous_value)
+        return value != previous_value;
+    return !streq (value, previous_value);
+}
+
+//  Send settings which can be changed at runtime to server. With previous
+//  config, only settings which changed since it are sent, so that reload
+//  does not restart schedulers or rebind exporter socket needlessly.
+static void
+s_send_settings (zactor_t *server, zconfig_t *config, zconfig_t *previous)
+{
+    if (s_changed (config, previous, "server/check_interval"))
+        zstr_sendx (server, "LINUXMETRICSINTERVAL", s_get (config, "server/check_interval", STR_DEFAULT_LINUXMETRICS_INTERVAL_SEC), NULL);
+    const char *release_details = s_get (config, "parameters/release_details", NULL);
+    if (release_details && s_changed (config, previous, "parameters/release_details"))
+        zstr_sendx (server, "RELEASE_DETAILS", release_details, NULL);
+
+    // server/announce_delta = <count>, deltas between full announcements (0 = none)
+    if (s_changed (config, previous, "server/announce_delta"))
+        zstr_sendx (server, "ANNOUNCEDELTA", s_get (config, "server/announce_delta", "0"), NULL);
+    // server/announce = <s>, period of re-announcement (0 = only on changes)
+    if (s_changed (config, previous, "server/announce"))
+        zstr_sendx (server, "ANNOUNCEINTERVAL", s_get (config, "server/announce", STR_DEFAULT_ANNOUNCE_INTERVAL_SEC), NULL);
+    // server/announce_quiet, server/announce_max_delay = <ms>, debounce of announcements
+    if (s_changed (config, previous, "server/announce_quiet")
+    ||  s_changed (config, previous, "server/announce_max_delay"))
+        zstr_sendx (server, "ANNOUNCEDEBOUNCE",
+            s_get (config, "server/announce_quiet", STR_DEFAULT_ANNOUNCE_QUIET_MS),
+            s_get (config, "server/announce_max_delay", STR_DEFAULT_ANNOUNCE_MAX_DELAY_MS), NULL);
+    // server/topology_cache = <count>, bound of assets cached while resolving topology
+    if (s_changed (config, previous, "server/topology_cache"))
+        zstr_sendx (server, "TOPOLOGYCACHE", s_get (config, "server/topology_cache", STR_DEFAULT_TOPOLOGY_CACHE_SIZE), NULL);
+    // server/timer_slack = <ms>, allowed delay of metrics ticks
+    if (s_changed (config, previous, "server/timer_slack"))
+        zstr_sendx (server, "TIMERSLACK", s_get (config, "server/timer_slack", "0"), NULL);
+    // server/metrics_socket = <path>, OpenMetrics exposition (disabled if
+    // empty), cleared or removed key on reload closes the socket
+    if (s_changed (config, previous, "server/metrics_socket"))
+        zstr_sendx (server, "METRICSSOCKET", s_get (config, "server/metrics_socket", ""), NULL);
+
+    // metrics/output = shm|stream|both
+    if (s_changed (config, previous, "metrics/output")) {
+        const char *output = s_get (config, "metrics/output", "shm");
+        if (!streq (output, "shm"))
+            zstr_sendx (server, "PRODUCER", FTY_PROTO_STREAM_METRICS, NULL);
+        zstr_sendx (server, "METRICSOUTPUT", output, NULL);
+    }
+
+    // metrics/policy/<type> = <policy>[:<threshold>]
+    zconfig_t *policy = zconfig_locate (config, "metrics/policy");
+    policy = policy ? zconfig_child (policy) : NULL;
+    while (policy) {
+        char *key = zsys_sprintf ("metrics/policy/%s", zconfig_name (policy));
+        if (s_changed (config, previous, key))
+            zstr_sendx (server, "METRICPOLICY", zconfig_name (policy), zconfig_value (policy), NULL);
+        zstr_free (&key);
+        policy = zconfig_next (policy);
+    }
+
+    // metrics/precision = "<unit>:<digits> ..."
+    if (!s_changed (config, previous, "metrics/precision"))
+        return;
+    char *precision = strdup (s_get (config, "metrics/precision", ""));
+    char *saveptr = NULL;
+    for (char *pair = strtok_r (precision, " ", &saveptr); pair; pair = strtok_r (NULL, " ", &saveptr)) {
+        char *digits = strrchr (pair, ':');
+        if (!digits || digits == pair) {
+            log_error ("metrics/precision: invalid item '%s'", pair);
+            continue;
+        }
+        *digits++ = '\0';
+        zstr_sendx (server, "METRICPRECISION", pair, digits, NULL);
+    }
+    free (precision);
 }
 
 void
@@ -50,8 +128,6 @@ usage(){
 
 int main (int argc, char *argv [])
 {
-    int linuxmetrics_interval = DEFAULT_LINUXMETRICS_INTERVAL_SEC;
-    char *str_linuxmetrics_interval = NULL;
     char *config_file = NULL;
     zconfig_t *config = NULL;
     char* actor_name = NULL;
@@ -60,6 +136,7 @@ int main (int argc, char *argv [])
     bool verbose = false;
     int argn;
     const char *hw_cap_path = "/usr/share/fty";
+    const char *release_details = NULL;
 
     ManageFtyLog::setInstanceFtylog (FTY_INFO_AGENT);
     std::string log_config_path;
@@ -107,16 +184,11 @@ int main (int argc, char *argv [])
             verbose = true;
         }
 
-        // Linux metrics publishing interval (in seconds)
-        str_linuxmetrics_interval = strdup(s_get (config, "server/check_interval", "30"));
-        if (str_linuxmetrics_interval) {
-            linuxmetrics_interval = atoi (str_linuxmetrics_interval);
-        }
-
         if (endpoint) zstr_free(&endpoint);
         endpoint = strdup(s_get (config, "malamute/endpoint", NULL));
         actor_name = strdup(s_get (config, "malamute/address", NULL));
         path = strdup(s_get (config, "parameters/path", NULL));
+        release_details = s_get (config, "parameters/release_details", NULL);
 
         log_config_path = std::string (s_get (config, "log/config", DEFAULT_LOG_CONFIG));
     }
@@ -133,37 +205,64 @@ int main (int argc, char *argv [])
         endpoint = strdup("ipc://@/malamute");
     if (path == NULL)
         path = strdup(DEFAULT_PATH);
-    if (str_linuxmetrics_interval == NULL)
-        str_linuxmetrics_interval = strdup(STR_DEFAULT_LINUXMETRICS_INTERVAL_SEC);
 
     zactor_t *server = zactor_new (fty_info_server, (void*) actor_name);
 
     //  Insert main code here
     zstr_sendx (server, "PATH", path, NULL);
     zstr_sendx (server, "CONFIG", hw_cap_path, NULL);
+    if (config_file)
+        zstr_sendx (server, "CONFIG_FILE", config_file, NULL);
     zstr_sendx (server, "CONNECT", endpoint, actor_name, NULL);
     zstr_sendx (server, "CONSUMER", FTY_PROTO_STREAM_ASSETS, ".*", NULL);
     zstr_sendx (server, "PRODUCER", "ANNOUNCE", NULL);
     zstr_sendx (server, "ROOT_DIR", "/", NULL);
-    zstr_sendx (server, "LINUXMETRICSINTERVAL", str_linuxmetrics_interval, NULL);
+    if (config)
+        s_send_settings (server, config, NULL);
+    else {
+        zstr_sendx (server, "LINUXMETRICSINTERVAL", STR_DEFAULT_LINUXMETRICS_INTERVAL_SEC, NULL);
+        zstr_sendx (server, "ANNOUNCEINTERVAL", STR_DEFAULT_ANNOUNCE_INTERVAL_SEC, NULL);
+    }
 
     // Run once actor to fill data about rackcontroller-0
     zactor_t *rc0_runonce = zactor_new (fty_info_rc0_runonce, (void *) RC0_RUNONCE_ACTOR);
+    if (release_details)
+        zstr_sendx (rc0_runonce, "RELEASE_DETAILS", release_details, NULL);
     zstr_sendx (rc0_runonce, "CONNECT", endpoint, actor_name, NULL);
     zstr_sendx (rc0_runonce, "CONSUMER", FTY_PROTO_STREAM_ASSETS, "device\\.rackcontroller.*", NULL);
 
-    zloop_t *timer_loop = zloop_new();
-    zloop_timer (timer_loop, linuxmetrics_interval * 1000, 0, s_linuxmetrics_event, server);
-    zloop_start (timer_loop);
+    // Linux metrics are scheduled by the server itself, just wait for the end
+    zpoller_t *poller = zpoller_new (server, NULL);
+    while (!zsys_interrupted) {
+        void *which = zpoller_wait (poller, 1000);
+        if (which == server) {
+            char *command = zstr_recv (server);
+            if (command && streq (command, "CONFIG_CHANGED")) {
+                // new and changed settings are applied, others stay
+                zconfig_t *reloaded = zconfig_load (config_file);
+                if (reloaded) {
+                    log_info ("fty_info: configuration file '%s' reloaded", config_file);
+                    s_send_settings (server, reloaded, config);
+                    zconfig_destroy (&config);
+                    config = reloaded;
+                }
+                else
+                    log_error ("Failed to reload config file %s", config_file);
+            }
+            zstr_free (&command);
+        }
+        else
+        if (zpoller_terminated (poller))
+            break;
+    }
 
     // Cleanup
-    zloop_destroy (&timer_loop);
+    zpoller_destroy (&poller);
     zactor_destroy (&server);
     zactor_destroy (&rc0_runonce);
     zstr_free (&actor_name);
     zstr_free (&endpoint);
     zstr_free (&path);
-    zstr_free (&str_linuxmetrics_interval);
     zconfig_destroy (&config);
 
     return 0;
@@ -47,12 +47,47 @@ typedef struct _ftyinfo_t ftyinfo_t;
 typedef struct _fty_info_rc0_runonce_t fty_info_rc0_runonce_t;
 #define FTY_INFO_RC0_RUNONCE_T_DEFINED
 #endif
+#ifndef METRICPUBLISHER_T_DEFINED
+typedef struct _metricpublisher_t metricpublisher_t;
+#define METRICPUBLISHER_T_DEFINED
+#endif
+#ifndef METRICSCHEDULER_T_DEFINED
+typedef struct _metricscheduler_t metricscheduler_t;
+#define METRICSCHEDULER_T_DEFINED
+#endif
+#ifndef METRICSEXPORTER_T_DEFINED
+typedef struct _metricsexporter_t metricsexporter_t;
+#define METRICSEXPORTER_T_DEFINED
+#endif
+#ifndef RELEASEDETAILS_T_DEFINED
+typedef struct _releasedetails_t releasedetails_t;
+#define RELEASEDETAILS_T_DEFINED
+#endif
+#ifndef INPUTWATCHER_T_DEFINED
+typedef struct _inputwatcher_t inputwatcher_t;
+#define INPUTWATCHER_T_DEFINED
+#endif
+#ifndef LOCALADDRS_T_DEFINED
+typedef struct _localaddrs_t localaddrs_t;
+#define LOCALADDRS_T_DEFINED
+#endif
+#ifndef HWCAP_T_DEFINED
+typedef struct _hwcap_t hwcap_t;
+#define HWCAP_T_DEFINED
+#endif
 
 //  Internal API
 
 #include "topologyresolver.h"
 #include "ftyinfo.h"
 #include "fty_info_rc0_runonce.h"
+#include "metricpublisher.h"
+#include "metricscheduler.h"
+#include "metricsexporter.h"
+#include "releasedetails.h"
+#include "inputwatcher.h"
+#include "localaddrs.h"
+#include "hwcap.h"
 
 //  *** To avoid double-definitions, only define if building without draft ***
 #ifndef FTY_INFO_BUILD_DRAFT_API
@@ -67,6 +102,41 @@ FTY_INFO_PRIVATE void
 FTY_INFO_PRIVATE void
     fty_info_rc0_runonce_test (bool verbose);
 
+//  *** Draft method, defined for internal use only ***
+//  Self test of this class.
+FTY_INFO_PRIVATE void
+    metricpublisher_test (bool verbose);
+
+//  *** Draft method, defined for internal use only ***
+//  Self test of this class.
+FTY_INFO_PRIVATE void
+    metricscheduler_test (bool verbose);
+
+//  *** Draft method, defined for internal use only ***
+//  Self test of this class.
+FTY_INFO_PRIVATE void
+    metricsexporter_test (bool verbose);
+
+//  *** Draft method, defined for internal use only ***
+//  Self test of this class.
+FTY_INFO_PRIVATE void
+    releasedetails_test (bool verbose);
+
+//  *** Draft method, defined for internal use only ***
+//  Self test of this class.
+FTY_INFO_PRIVATE void
+    inputwatcher_test (bool verbose);
+
+//  *** Draft method, defined for internal use only ***
+//  Self test of this class.
+FTY_INFO_PRIVATE void
+    localaddrs_test (bool verbose);
+
+//  *** Draft method, defined for internal use only ***
+//  Self test of this class.
+FTY_INFO_PRIVATE void
+    hwcap_test (bool verbose);
+
 //  Self test for private classes
 FTY_INFO_PRIVATE void
     fty_info_private_selftest (bool verbose, const char *subtest);
@@ -42,6 +42,20 @@ fty_info_private_selftest (bool verbose, const char *subtest)
         topologyresolver_test (verbose);
     if (streq (subtest, "$ALL") || streq (subtest, "fty_info_rc0_runonce_test"))
         fty_info_rc0_runonce_test (verbose);
+    if (streq (subtest, "$ALL") || streq (subtest, "metricpublisher_test"))
+        metricpublisher_test (verbose);
+    if (streq (subtest, "$ALL") || streq (subtest, "metricscheduler_test"))
+        metricscheduler_test (verbose);
+    if (streq (subtest, "$ALL") || streq (subtest, "metricsexporter_test"))
+        metricsexporter_test (verbose);
+    if (streq (subtest, "$ALL") || streq (subtest, "releasedetails_test"))
+        releasedetails_test (verbose);
+    if (streq (subtest, "$ALL") || streq (subtest, "inputwatcher_test"))
+        inputwatcher_test (verbose);
+    if (streq (subtest, "$ALL") || streq (subtest, "localaddrs_test"))
+        localaddrs_test (verbose);
+    if (streq (subtest, "$ALL") || streq (subtest, "hwcap_test"))
+        hwcap_test (verbose);
 }
 /*
 ################################################################################
@@ -27,6 +27,7 @@
 */
 
 #include "fty_info_classes.h"
+#include <string>
 
 //  Structure of our class
 
@@ -34,7 +35,9 @@ struct _fty_info_rc0_runonce_t {
     char *name;
     char *endpoint;
     topologyresolver_t *resolver;
-    ftyinfo_t *info;
+    releasedetails_t *details;
+    ftyinfo_t *info;            // built on first rackcontroller-0 update
+    localaddrs_t *addrs;        // created with info, follows address changes
     mlm_client_t *client;
 };
 
@@ -51,7 +54,7 @@ fty_info_rc0_runonce_new (char *name)
     self->name=strdup(name);
     self->client = mlm_client_new ();
     self->resolver = topologyresolver_new (DEFAULT_RC_INAME);
-    self->info = ftyinfo_new (self->resolver, DEFAULT_PATH);
+    self->details = releasedetails_new (NULL);
     return self;
 }
 
@@ -69,6 +72,8 @@ fty_info_rc0_runonce_destroy (fty_info_rc0_runonce_t **self_p)
         mlm_client_destroy (&(self->client));
         zstr_free(&(self->name));
         ftyinfo_destroy (&(self->info));
+        releasedetails_destroy (&(self->details));
+        localaddrs_destroy (&(self->addrs));
         topologyresolver_destroy (&(self->resolver));
         zstr_free(&(self->endpoint));
         //  Free object itself
@@ -125,6 +130,14 @@ handle_stream(fty_info_rc0_runonce_t *self, zmsg_t *msg)
     }
 
     // just for rackcontroller-0
+    if (!self->info) {
+        releasedetails_refresh (self->details);
+        // subscribed, so that pending notifications can be applied below
+        self->addrs = localaddrs_new (true);
+        self->info = ftyinfo_new (self->resolver, DEFAULT_PATH, self->details, self->addrs);
+    }
+    else
+        localaddrs_update (self->addrs);
     int changeRW = 0;
     int changeRO = 0;
 
@@ -210,35 +223,14 @@ handle_stream(fty_info_rc0_runonce_t *self, zmsg_t *msg)
 
     data = fty_proto_ext_string(message, "ip.1", NULL);
     if (NULL == data) {
-        struct ifaddrs *interfaces, *iface;
-        char host[NI_MAXHOST];
-        if (getifaddrs (&interfaces) != -1) {
-            int counter = 0;
-            for (iface = interfaces; iface != NULL; iface = iface->ifa_next) {
-                if (iface->ifa_addr == NULL) continue;
-                // here we support IPv4 only, only get first 3 addresses
-                if (iface->ifa_addr->sa_family == AF_INET &&
-                        getnameinfo(iface->ifa_addr,sizeof(struct sockaddr_in),
-                                host, NI_MAXHOST, NULL, 0, NI_NUMERICHOST) == 0) {
-                    switch(counter) {
-                        case 0:
-                            fty_proto_ext_insert(messageRO, "ip.1", "%s", host);
-                            break;
-                        case 1:
-                            fty_proto_ext_insert(messageRO, "ip.2", "%s", host);
-                            break;
-                        case 2:
-                            fty_proto_ext_insert(messageRO, "ip.3", "%s", host);
-                            break;
-                    }
-                    changeRO = 1;
-                    ++counter;
-                }
-                if (counter == 3) {
-                    break;
-                }
-            }
-            freeifaddrs(interfaces);
+        // here we support IPv4 only, only get first 3 addresses
+        for (int counter = 0; counter < 3; ++counter) {
+            const char *ip = localaddrs_ipv4 (self->addrs, counter);
+            if (!ip)
+                break;
+            std::string key = "ip." + std::to_string (counter + 1);
+            fty_proto_ext_insert(messageRO, key.c_str (), "%s", ip);
+            changeRO = 1;
         }
     }
 
@@ -322,6 +314,13 @@ handle_pipe(fty_info_rc0_runonce_t *self, zmsg_t *message)
         zstr_free (&pattern);
         zstr_free (&stream);
     }
+    else
+    if (streq (command, "RELEASE_DETAILS")) {
+        char *path = zmsg_popstr (message);
+        if (path)
+            releasedetails_set_path (self->details, path);
+        zstr_free (&path);
+    }
     else
         log_error ("fty-info-rc0-runonce: Unknown actor command: %s.\n", command);
 
@@ -48,6 +48,13 @@ all_tests [] = {
 // Now built only with --enable-drafts, so even stable builds are hidden behind the flag
     { "topologyresolver", NULL, true, false, "topologyresolver_test" },
     { "fty_info_rc0_runonce", NULL, true, false, "fty_info_rc0_runonce_test" },
+    { "metricpublisher", NULL, true, false, "metricpublisher_test" },
+    { "metricscheduler", NULL, true, false, "metricscheduler_test" },
+    { "metricsexporter", NULL, true, false, "metricsexporter_test" },
+    { "releasedetails", NULL, true, false, "releasedetails_test" },
+    { "inputwatcher", NULL, true, false, "inputwatcher_test" },
+    { "localaddrs", NULL, true, false, "localaddrs_test" },
+    { "hwcap", NULL, true, false, "hwcap_test" },
     { "private_classes", NULL, false, false, "$ALL" }, // compat option for older projects
 #endif // FTY_INFO_BUILD_DRAFT_API
     {NULL, NULL, 0, 0, NULL}          //  Sentinel
@@ -33,11 +33,38 @@
 #include <fstream>
 #include <set>
 #include <map>
+#include <vector>
+#include <atomic>
+#include <cmath>
 #include <ifaddrs.h>
 
 #include "fty_info_classes.h"
 
-#define HW_CAP_FILE "42ity-capabilities.dsc"
+// INFO snapshot is rebuilt at least this often, in case some change was missed;
+// all its inputs are watched, so this is only a safety net
+#define INFO_MAX_AGE_MS (10 * 60 * 1000)
+// at most this many client messages are received per wake-up
+#define CLIENT_DRAIN_MAX 256
+
+// mailbox commands with own statistics, the last one counts all others
+static const char *s_stats_commands [] = {
+    "INFO", "INFO-TEST", "INFO-IF-CHANGED", "INFO-FIELDS", "HW_CAP", "BATCH", "STATS", "other"
+};
+#define STATS_COMMANDS (sizeof (s_stats_commands) / sizeof (s_stats_commands [0]))
+
+// upper bounds of reply latency buckets [us], the last bucket is unbounded
+static const int64_t s_latency_bounds [] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000
+};
+#define LATENCY_BOUNDS (sizeof (s_latency_bounds) / sizeof (s_latency_bounds [0]))
+
+// statistics of one mailbox command
+typedef struct {
+    std::atomic<uint64_t> requests;
+    std::atomic<uint64_t> replies;
+    std::atomic<uint64_t> latency_sum;                          // [us]
+    std::atomic<uint64_t> latency_buckets [LATENCY_BOUNDS + 1]; // not cumulative
+} mailbox_stats_t;
 
 struct _fty_info_server_t {
     //  Declare class properties here
@@ -46,6 +73,8 @@ struct _fty_info_server_t {
     char* path;
     mlm_client_t *client;
     mlm_client_t *announce_client;
+    uint64_t assets_decoded;        // asset messages decoded
+    uint64_t assets_dropped;        // asset messages dropped before decoding
     bool first_announce;
     bool test;
     topologyresolver_t* resolver;
@@ -53,6 +82,40 @@ struct _fty_info_server_t {
     std::string root_dir; //directory to be considered / - used for testing
     zhashx_t *history;
     char *hw_cap_path;
+    hwcap_t *hwcap;                 // parsed capabilities from hw_cap_path
+    metricpublisher_t *publisher;
+    metricscheduler_t *scheduler;
+    metricscheduler_t *announce_scheduler; // periodic re-announcement
+    metricsexporter_t *exporter;    // NULL when exposition is disabled
+    releasedetails_t *details;      // parsed release details
+    inputwatcher_t *watcher;        // changes of files INFO is derived from
+    localaddrs_t *localaddrs;       // local IP addresses, kept up to date
+    ftyinfo_t *info;                // INFO snapshot, NULL until first use
+    zframe_t *info_packed;          // packed infohash of the snapshot
+    zmsg_t *info_msg;               // encoded INFO message of the snapshot
+    uint64_t info_version;          // incremented when content of snapshot changes
+    int64_t info_epoch;             // start time, makes tags unique across restarts
+    char info_tag [48];             // version tag of snapshot sent to clients
+    uint64_t info_resolver_version; // resolver version the snapshot was built from
+    int64_t info_time;              // when the snapshot was built
+    bool info_invalid;              // some input changed, rebuild on next use
+    int announce_full_every;        // deltas between full announcements, 0 = no deltas
+    int announce_deltas;            // deltas sent since last full announcement
+    bool announce_full_needed;      // next announcement must be full
+    uint64_t announce_seq;          // sequence number of last announcement
+    zhash_t *announce_last;         // infohash of last sent announcement
+    int announce_quiet;             // debounce window [ms], 0 = announce at once
+    int announce_max_delay;         // longest delay of pending announcement [ms]
+    bool announce_pending;          // some change was not announced yet
+    int64_t announce_first_change;  // first change not announced yet
+    int64_t announce_last_change;   // last change not announced yet
+    uint64_t announce_published;    // sent announcements
+    uint64_t announce_suppressed;   // changes merged into other announcement
+    uint64_t mailbox_wakeups;       // wake-ups which received mailbox requests
+    uint64_t mailbox_requests;      // received mailbox requests
+    size_t mailbox_drained_max;     // most mailbox requests received at once
+    int64_t reply_latency_max;      // longest request to reply time [us]
+    mailbox_stats_t stats [STATS_COMMANDS];
 };
 
 // this is kept for to handle with values set to ""
@@ -84,13 +147,67 @@ info_server_new (char *name)
     assert (self);
     //  Initialize class properties here
     self->name=strdup(name);
+    self->endpoint = NULL;
+    self->path = NULL;
     self->client = mlm_client_new ();
     self->announce_client = mlm_client_new ();
+    self->assets_decoded = 0;
+    self->assets_dropped = 0;
     self->first_announce=true;
     self->test = false;
     self->history = zhashx_new();
     self->hw_cap_path = NULL;
+    self->hwcap = hwcap_new ();
     self->resolver = topologyresolver_new (DEFAULT_RC_INAME);
+    self->localaddrs = localaddrs_new (true);
+    topologyresolver_set_localaddrs (self->resolver, self->localaddrs);
+    topologyresolver_set_cache_size (self->resolver, DEFAULT_TOPOLOGY_CACHE_SIZE);
+    self->publisher = metricpublisher_new ();
+    self->scheduler = metricscheduler_new ();
+    self->announce_scheduler = metricscheduler_new ();
+    self->exporter = NULL;
+    self->details = releasedetails_new (NULL);
+    self->watcher = inputwatcher_new ();
+    inputwatcher_add (self->watcher, INPUT_RELEASE_DETAILS, releasedetails_path (self->details));
+    inputwatcher_add (self->watcher, INPUT_HOSTNAME, HOSTNAME_FILE);
+    char *license = ftyinfo_license_file ();
+    if (license)
+        inputwatcher_add (self->watcher, INPUT_LICENSE, license);
+    zstr_free (&license);
+    self->info = NULL;
+    self->info_packed = NULL;
+    self->info_msg = NULL;
+    self->info_version = 0;
+    self->info_epoch = zclock_time ();
+    self->info_tag [0] = 0;
+    self->info_resolver_version = 0;
+    self->info_time = 0;
+    self->info_invalid = true;
+    self->announce_full_every = 0;
+    self->announce_deltas = 0;
+    self->announce_full_needed = true;
+    self->announce_seq = 0;
+    self->announce_last = NULL;
+    self->announce_quiet = DEFAULT_ANNOUNCE_QUIET_MS;
+    self->announce_max_delay = DEFAULT_ANNOUNCE_MAX_DELAY_MS;
+    self->announce_pending = false;
+    self->announce_first_change = 0;
+    self->announce_last_change = 0;
+    self->announce_published = 0;
+    self->announce_suppressed = 0;
+    self->mailbox_wakeups = 0;
+    self->mailbox_requests = 0;
+    self->mailbox_drained_max = 0;
+    self->reply_latency_max = 0;
+    for (size_t i = 0; i < STATS_COMMANDS; i++) {
+        self->stats [i].requests = 0;
+        self->stats [i].replies = 0;
+        self->stats [i].latency_sum = 0;
+        for (size_t j = 0; j <= LATENCY_BOUNDS; j++)
+            self->stats [i].latency_buckets [j] = 0;
+    }
+    // totals change only with hardware or partitioning
+    metricpublisher_set_policy (self->publisher, "total.", METRIC_POLICY_ON_CHANGE, 0);
     zhashx_set_destructor(self->history, history_destructor);
     zhashx_insert(self->history, HIST_CPU_NUMERATOR, numerator_ptr);
     zhashx_insert(self->history, HIST_CPU_DENOMINATOR, denominator_ptr);
@@ -112,8 +229,20 @@ info_server_destroy (fty_info_server_t  **self_p)
         zstr_free(&self->endpoint);
         zstr_free(&self->path);
         topologyresolver_destroy (&self->resolver);
+        localaddrs_destroy (&self->localaddrs);
         zhashx_destroy(&self->history);
         zstr_free(&self->hw_cap_path);
+        hwcap_destroy (&self->hwcap);
+        metricpublisher_destroy (&self->publisher);
+        metricscheduler_destroy (&self->scheduler);
+        metricscheduler_destroy (&self->announce_scheduler);
+        metricsexporter_destroy (&self->exporter);
+        ftyinfo_destroy (&self->info);
+        releasedetails_destroy (&self->details);
+        inputwatcher_destroy (&self->watcher);
+        zframe_destroy (&self->info_packed);
+        zmsg_destroy (&self->info_msg);
+        zhash_destroy (&self->announce_last);
         //  Free object itself
         delete self;
         *self_p = NULL;
@@ -139,6 +268,64 @@ char *s_get_name(const char *name, const char *uuid)
     return buffer;
 }
 
+static zmsg_t*
+s_create_info (ftyinfo_t *info, zframe_t *packed);
+
+//  --------------------------------------------------------------------------
+//  Mark INFO snapshot outdated, it is rebuilt on next use
+static void
+s_info_invalidate (fty_info_server_t *self, const char *reason)
+{
+    log_debug ("INFO snapshot invalidated: %s", reason);
+    self->info_invalid = true;
+}
+
+//  --------------------------------------------------------------------------
+//  Return current INFO snapshot, owned by server. It is rebuilt only if
+//  some input changed, version is incremented only if its content changed.
+static ftyinfo_t *
+s_info (fty_info_server_t *self)
+{
+    int64_t now = zclock_mono ();
+    if (self->info && !self->info_invalid
+    &&  self->info_resolver_version == topologyresolver_version (self->resolver)
+    &&  now - self->info_time < INFO_MAX_AGE_MS)
+        return self->info;
+
+    releasedetails_refresh (self->details);
+    ftyinfo_t *info = ftyinfo_new (self->resolver, self->path, self->details, self->localaddrs);
+    zframe_t *packed = zhash_pack (ftyinfo_infohash (info));
+    bool changed = !self->info_packed || !zframe_eq (packed, self->info_packed);
+    ftyinfo_destroy (&self->info);
+    zframe_destroy (&self->info_packed);
+    self->info = info;
+    self->info_packed = packed;
+    if (changed) {
+        // encode reply only once per version
+        self->info_version++;
+        zmsg_destroy (&self->info_msg);
+        self->info_msg = s_create_info (self->info, self->info_packed);
+        snprintf (self->info_tag, sizeof (self->info_tag), "%llx-%llu",
+            (unsigned long long) self->info_epoch, (unsigned long long) self->info_version);
+        log_debug ("INFO snapshot version %s", self->info_tag);
+    }
+    // missing parents are only requested while building, their replies
+    // change the version later
+    self->info_resolver_version = topologyresolver_version (self->resolver);
+    self->info_time = now;
+    self->info_invalid = false;
+    return self->info;
+}
+
+//  --------------------------------------------------------------------------
+//  Return copy of encoded INFO message of current snapshot
+static zmsg_t *
+s_info_msg (fty_info_server_t *self)
+{
+    s_info (self);
+    return zmsg_dup (self->info_msg);
+}
+
 // create INFO reply/publish message
 //  body :
 //    - INFO (command))
@@ -162,8 +349,9 @@ char *s_get_name(const char *name, const char *uuid)
 //          type (meaning device type)
 //          hostname
 //          txtvers
+//  packed is infohash of info already packed, NULL to pack it here
 static zmsg_t*
-s_create_info (ftyinfo_t *info)
+s_create_info (ftyinfo_t *info, zframe_t *packed)
 {
     zmsg_t *msg=zmsg_new();
     zmsg_addstr (msg, FTY_INFO_CMD);
@@ -177,8 +365,7 @@ s_create_info (ftyinfo_t *info)
     zmsg_addstr (msg, SRV_STYPE);
     zmsg_addstr (msg, SRV_PORT);
 
-    zhash_t *map = ftyinfo_infohash (info);
-    zframe_t * frame_infos = zhash_pack(map);
+    zframe_t * frame_infos = packed ? zframe_dup (packed) : zhash_pack (ftyinfo_infohash (info));
     zmsg_append (msg, &frame_infos);
 
     zstr_free(&srv_name);
@@ -186,38 +373,158 @@ s_create_info (ftyinfo_t *info)
     return msg;
 }
 
+//  --------------------------------------------------------------------------
+//  create announcement of current snapshot. In delta mode, it is either
+//  full INFO message followed by sequence number, or
+//    - INFO-DELTA
+//    - sequence number
+//    - hashtable : changed TXT names and values
+//    - removed TXT names, one per frame
+//  Full message is sent first, every announce_full_every deltas, after a
+//  failed send and when uuid (and so the service name) changes.
+static zmsg_t *
+s_announce_msg (fty_info_server_t *self, bool *full)
+{
+    *full = true;
+    if (self->announce_full_every <= 0)
+        return s_info_msg (self);
+
+    zhash_t *infos = ftyinfo_infohash (s_info (self));
+    self->announce_seq++;
+
+    zhash_t *changed = zhash_new ();
+    zlistx_t *removed = zlistx_new ();
+    bool uuid_changed = false;
+    if (self->announce_last) {
+        for (const char *value = (const char *) zhash_first (infos); value; value = (const char *) zhash_next (infos)) {
+            const char *last = (const char *) zhash_lookup (self->announce_last, zhash_cursor (infos));
+            if (!last || !streq (last, value))
+                zhash_insert (changed, zhash_cursor (infos), (void *) value);
+        }
+        for (const char *last = (const char *) zhash_first (self->announce_last); last; last = (const char *) zhash_next (self->announce_last)) {
+            if (!zhash_lookup (infos, zhash_cursor (self->announce_last)))
+                zlistx_add_end (removed, (void *) zhash_cursor (self->announce_last));
+        }
+        uuid_changed = zhash_lookup (changed, INFO_UUID) || !zhash_lookup (infos, INFO_UUID);
+    }
+    *full = !self->announce_last
+         || self->announce_full_needed
+         || self->announce_deltas >= self->announce_full_every
+         || uuid_changed;
+
+    zmsg_t *msg;
+    if (*full) {
+        msg = s_info_msg (self);
+        zmsg_addstrf (msg, "%llu", (unsigned long long) self->announce_seq);
+    }
+    else {
+        msg = zmsg_new ();
+        zmsg_addstr (msg, "INFO-DELTA");
+        zmsg_addstrf (msg, "%llu", (unsigned long long) self->announce_seq);
+        zframe_t *frame = zhash_pack (changed);
+        zmsg_append (msg, &frame);
+        for (const char *key = (const char *) zlistx_first (removed); key; key = (const char *) zlistx_next (removed))
+            zmsg_addstr (msg, key);
+    }
+    zlistx_destroy (&removed);
+    zhash_destroy (&changed);
+
+    zhash_destroy (&self->announce_last);
+    self->announce_last = zhash_dup (infos);
+    return msg;
+}
+
 //  --------------------------------------------------------------------------
 //  publish INFO announcement on STREAM ANNOUNCE/ANNOUNCE-TEST
 //  subject : CREATE/UPDATE
 static void
 s_publish_announce(fty_info_server_t  * self)
 {
-
-    if(!mlm_client_connected(self->announce_client))
+    // this one covers all pending changes; without connection they are
+    // covered by the first announcement after PRODUCER or by re-announcement
+    self->announce_pending = false;
+    if(!mlm_client_connected(self->announce_client)) {
+        self->announce_full_needed = true;
         return;
-    ftyinfo_t *info;
-    if (!self->test) {
-        info = ftyinfo_new (self->resolver,self->path);
     }
-    else
-        info = ftyinfo_test_new ();
-
-    zmsg_t *msg = s_create_info (info);
+    self->announce_published++;
+    zmsg_t *msg;
+    bool full = true;
+    if (!self->test)
+        msg = s_announce_msg (self, &full);
+    else {
+        ftyinfo_t *info = ftyinfo_test_new ();
+        msg = s_create_info (info, NULL);
+        ftyinfo_destroy (&info);
+    }
 
+    int rv;
     if (self->first_announce) {
-        if (mlm_client_send (self->announce_client, "CREATE", &msg) != -1) {
+        if ((rv = mlm_client_send (self->announce_client, "CREATE", &msg)) != -1) {
             log_info("publish CREATE msg on ANNOUNCE STREAM");
             self->first_announce=false;
         }
         else
             log_error("cant publish CREATE msg on ANNOUNCE STREAM");
     } else {
-        if (mlm_client_send (self->announce_client, "UPDATE", &msg) != -1)
+        if ((rv = mlm_client_send (self->announce_client, "UPDATE", &msg)) != -1)
             log_info("publish UPDATE msg on ANNOUNCE STREAM");
         else
             log_error("cant publish UPDATE msg on ANNOUNCE STREAM");
     }
-    ftyinfo_destroy (&info);
+    zmsg_destroy (&msg);
+
+    // consumers can't apply following deltas if this one was lost
+    self->announce_full_needed = rv == -1;
+    if (full)
+        self->announce_deltas = 0;
+    else
+        self->announce_deltas++;
+}
+
+//  --------------------------------------------------------------------------
+//  periodic re-announcement for consumers which joined later or missed one.
+//  It is always full and uses the cached message unless snapshot changed.
+static void
+s_reannounce (fty_info_server_t *self)
+{
+    if (self->first_announce)
+        return;
+    self->announce_full_needed = true;
+    s_publish_announce (self);
+}
+
+//  --------------------------------------------------------------------------
+//  announce change once no other change came for announce_quiet ms, changes
+//  during asset floods (like REPUBLISH) are announced together
+static void
+s_announce_later (fty_info_server_t *self)
+{
+    if (self->announce_quiet <= 0) {
+        s_publish_announce (self);
+        return;
+    }
+    int64_t now = zclock_mono ();
+    if (self->announce_pending)
+        self->announce_suppressed++;
+    else {
+        self->announce_pending = true;
+        self->announce_first_change = now;
+    }
+    self->announce_last_change = now;
+}
+
+//  --------------------------------------------------------------------------
+//  Return ms until pending announcement is due, -1 if there is none
+static int
+s_announce_timeout (fty_info_server_t *self, int64_t now)
+{
+    if (!self->announce_pending)
+        return -1;
+    int64_t due = self->announce_last_change + self->announce_quiet;
+    if (due > self->announce_first_change + self->announce_max_delay)
+        due = self->announce_first_change + self->announce_max_delay;
+    return due > now ? (int) (due - now) : 0;
 }
 
 //  --------------------------------------------------------------------------
@@ -236,27 +543,164 @@ s_publish_linuxmetrics (fty_info_server_t  * self)
     int ttl = 3 * self->linuxmetrics_interval; // in seconds
     char *rc_iname = topologyresolver_id (self->resolver);
 
+    // prepare all records of this cycle first, then write them in one pass
+    metricpublisher_begin (self->publisher);
     linuxmetric_t *metric = (linuxmetric_t *) zlistx_first (info);
     while (metric) {
-        char *value = zsys_sprintf ("%lf", metric->value);
-        log_debug ("Publishing metric %s, value %lf, unit %s", metric->type , metric->value, metric->unit);
-
-        if(fty::shm::write_metric(rc_iname, metric->type, value, metric->unit, ttl) == 0) {
-            log_trace ("Metric %s published", metric->type);
-        }
-        else {
-            log_error ("Can't publish metric %s", metric->type);
-        }
+        metricpublisher_add (self->publisher, metric->type, metric->value, metric->unit);
         linuxmetric_destroy (&metric);
         metric = (linuxmetric_t *) zlistx_next (info);
-        zstr_free (&value);
     }
 
+    size_t failed = metricpublisher_commit (self->publisher, rc_iname, ttl);
+    if (failed)
+        log_error ("%zu of %zu metrics could not be published", failed, metricpublisher_size (self->publisher));
+    log_debug ("metrics written: %zu, suppressed: %zu",
+            (size_t) metricpublisher_written_total (self->publisher),
+            (size_t) metricpublisher_suppressed_total (self->publisher));
+    log_debug ("metrics ticks: %zu, overruns: %zu, lateness: %lld ms (max %lld ms)",
+            (size_t) metricscheduler_ticks (self->scheduler),
+            (size_t) metricscheduler_overruns (self->scheduler),
+            (long long) metricscheduler_lateness (self->scheduler),
+            (long long) metricscheduler_lateness_max (self->scheduler));
+
     free(rc_iname);
     zlistx_destroy (&info);
 
 }
 
+//  --------------------------------------------------------------------------
+//  Add unlabeled sample with numeric value to the exposition
+static void
+s_export_number (metricsexporter_t *exporter, const char *name, double value)
+{
+    char value_str [METRICPUBLISHER_VALUE_MAX];
+    metricpublisher_format (value_str, sizeof (value_str), value, -1);
+    metricsexporter_sample (exporter, name);
+    metricsexporter_value (exporter, value_str);
+}
+
+//  --------------------------------------------------------------------------
+//  serve OpenMetrics exposition of last Linux metrics, INFO and counters
+static void
+s_export_metrics (fty_info_server_t *self)
+{
+    int fd = metricsexporter_accept (self->exporter);
+    if (fd == -1)
+        return;
+
+    metricsexporter_t *exporter = self->exporter;
+    char value_str [METRICPUBLISHER_VALUE_MAX];
+    metricsexporter_begin (exporter);
+
+    metricsexporter_family (exporter, "fty_info_linux_metric", "gauge", "Last published Linux system metrics");
+    for (size_t i = 0; i < metricpublisher_size (self->publisher); i++) {
+        metricsexporter_sample (exporter, "fty_info_linux_metric");
+        metricsexporter_label (exporter, "asset", metricpublisher_asset (self->publisher));
+        metricsexporter_label (exporter, "type", metricpublisher_type (self->publisher, i));
+        metricsexporter_label (exporter, "unit", metricpublisher_unit (self->publisher, i));
+        metricsexporter_value (exporter, metricpublisher_value (self->publisher, i));
+    }
+
+    ftyinfo_t *test_info = self->test ? ftyinfo_test_new () : NULL;
+    zhash_t *infos = ftyinfo_infohash (self->test ? test_info : s_info (self));
+    metricsexporter_family (exporter, "fty_info", "info", "Rack controller information");
+    metricsexporter_sample (exporter, "fty_info_info");
+    for (const char *value = (const char *) zhash_first (infos); value; value = (const char *) zhash_next (infos))
+        metricsexporter_label (exporter, zhash_cursor (infos), value);
+    metricsexporter_value (exporter, "1");
+    ftyinfo_destroy (&test_info);
+
+    metricsexporter_family (exporter, "fty_info_metrics_written", "counter", "Linux metrics published");
+    s_export_number (exporter, "fty_info_metrics_written_total", metricpublisher_written_total (self->publisher));
+    metricsexporter_family (exporter, "fty_info_metrics_suppressed", "counter", "Linux metrics suppressed by their policy");
+    s_export_number (exporter, "fty_info_metrics_suppressed_total", metricpublisher_suppressed_total (self->publisher));
+    metricsexporter_family (exporter, "fty_info_metrics_ticks", "counter", "Linux metrics publishing cycles");
+    s_export_number (exporter, "fty_info_metrics_ticks_total", metricscheduler_ticks (self->scheduler));
+    metricsexporter_family (exporter, "fty_info_metrics_overruns", "counter", "Linux metrics cycles skipped as previous one was late");
+    s_export_number (exporter, "fty_info_metrics_overruns_total", metricscheduler_overruns (self->scheduler));
+    metricsexporter_family (exporter, "fty_info_metrics_lateness_seconds", "counter", "Sum of lateness of Linux metrics cycles");
+    s_export_number (exporter, "fty_info_metrics_lateness_seconds_total", metricscheduler_lateness_total (self->scheduler) / 1000.0);
+    metricsexporter_family (exporter, "fty_info_metrics_lateness_max_seconds", "gauge", "Maximal lateness of Linux metrics cycle");
+    s_export_number (exporter, "fty_info_metrics_lateness_max_seconds", metricscheduler_lateness_max (self->scheduler) / 1000.0);
+    metricsexporter_family (exporter, "fty_info_assets_decoded", "counter", "Asset messages decoded");
+    s_export_number (exporter, "fty_info_assets_decoded_total", self->assets_decoded);
+    metricsexporter_family (exporter, "fty_info_assets_dropped", "counter", "Asset messages dropped before decoding");
+    s_export_number (exporter, "fty_info_assets_dropped_total", self->assets_dropped);
+    metricsexporter_family (exporter, "fty_info_topology_cache_entries", "gauge", "Assets cached for resolving topology");
+    s_export_number (exporter, "fty_info_topology_cache_entries", topologyresolver_cache_size (self->resolver));
+    metricsexporter_family (exporter, "fty_info_topology_cache_bytes", "gauge", "Bytes allocated by assets cached for resolving topology");
+    s_export_number (exporter, "fty_info_topology_cache_bytes", topologyresolver_cache_bytes (self->resolver));
+    metricsexporter_family (exporter, "fty_info_mailbox_wakeups", "counter", "Wake-ups which received mailbox requests");
+    s_export_number (exporter, "fty_info_mailbox_wakeups_total", self->mailbox_wakeups);
+    metricsexporter_family (exporter, "fty_info_mailbox_requests", "counter", "Received mailbox requests");
+    s_export_number (exporter, "fty_info_mailbox_requests_total", self->mailbox_requests);
+    metricsexporter_family (exporter, "fty_info_mailbox_drained_max", "gauge", "Most mailbox requests received in one wake-up");
+    s_export_number (exporter, "fty_info_mailbox_drained_max", self->mailbox_drained_max);
+    // sum is exported per command by fty_info_mailbox_reply_latency_seconds,
+    // maximum can't be read from its buckets
+    metricsexporter_family (exporter, "fty_info_reply_latency_max_seconds", "gauge", "Longest time from receiving mailbox request to sending its reply");
+    s_export_number (exporter, "fty_info_reply_latency_max_seconds", self->reply_latency_max / 1000000.0);
+    metricsexporter_family (exporter, "fty_info_mailbox_command_requests", "counter", "Received mailbox requests by command");
+    for (size_t i = 0; i < STATS_COMMANDS; i++) {
+        metricsexporter_sample (exporter, "fty_info_mailbox_command_requests_total");
+        metricsexporter_label (exporter, "command", s_stats_commands [i]);
+        metricpublisher_format (value_str, sizeof (value_str), self->stats [i].requests.load (std::memory_order_relaxed), -1);
+        metricsexporter_value (exporter, value_str);
+    }
+    metricsexporter_family (exporter, "fty_info_mailbox_reply_latency_seconds", "histogram", "Time from receiving mailbox request to sending its reply");
+    for (size_t i = 0; i < STATS_COMMANDS; i++) {
+        mailbox_stats_t *stats = &self->stats [i];
+        uint64_t cumulative = 0;
+        for (size_t j = 0; j <= LATENCY_BOUNDS; j++) {
+            cumulative += stats->latency_buckets [j].load (std::memory_order_relaxed);
+            metricsexporter_sample (exporter, "fty_info_mailbox_reply_latency_seconds_bucket");
+            metricsexporter_label (exporter, "command", s_stats_commands [i]);
+            metricsexporter_label_bound (exporter, j < LATENCY_BOUNDS ? s_latency_bounds [j] / 1000000.0 : INFINITY);
+            metricpublisher_format (value_str, sizeof (value_str), cumulative, -1);
+            metricsexporter_value (exporter, value_str);
+        }
+        metricsexporter_sample (exporter, "fty_info_mailbox_reply_latency_seconds_count");
+        metricsexporter_label (exporter, "command", s_stats_commands [i]);
+        metricpublisher_format (value_str, sizeof (value_str), cumulative, -1);
+        metricsexporter_value (exporter, value_str);
+        metricsexporter_sample (exporter, "fty_info_mailbox_reply_latency_seconds_sum");
+        metricsexporter_label (exporter, "command", s_stats_commands [i]);
+        metricpublisher_format (value_str, sizeof (value_str), stats->latency_sum.load (std::memory_order_relaxed) / 1000000.0, -1);
+        metricsexporter_value (exporter, value_str);
+    }
+    metricsexporter_family (exporter, "fty_info_announcements", "counter", "Published announcements");
+    s_export_number (exporter, "fty_info_announcements_total", self->announce_published);
+    metricsexporter_family (exporter, "fty_info_announcements_suppressed", "counter", "Changes merged into another announcement");
+    s_export_number (exporter, "fty_info_announcements_suppressed_total", self->announce_suppressed);
+    metricsexporter_family (exporter, "fty_info_scrapes", "counter", "Served expositions");
+    s_export_number (exporter, "fty_info_scrapes_total", metricsexporter_scrapes (exporter));
+
+    metricsexporter_send (exporter, fd);
+}
+
+//  --------------------------------------------------------------------------
+//  invalidate what is derived from changed inputs
+static void
+s_handle_inputs (fty_info_server_t *self, zsock_t *pipe, int changed)
+{
+    if (changed & INPUT_RELEASE_DETAILS)
+        s_info_invalidate (self, "release details changed");
+    if (changed & INPUT_LICENSE)
+        s_info_invalidate (self, "license changed");
+    if (changed & INPUT_HOSTNAME)
+        s_info_invalidate (self, "hostname changed");
+    if ((changed & INPUT_HW_CAP) && self->hw_cap_path) {
+        char *file = zsys_sprintf ("%s/%s", self->hw_cap_path, HW_CAP_FILE);
+        hwcap_load (self->hwcap, file);
+        zstr_free (&file);
+    }
+    if (changed & INPUT_CONFIG) {
+        log_info ("configuration file changed");
+        zstr_send (pipe, "CONFIG_CHANGED");
+    }
+}
+
 //  --------------------------------------------------------------------------
 //  process pipe message
 //  return true means continue, false means TERM
@@ -285,6 +729,7 @@ s_handle_pipe(fty_info_server_t* self,zmsg_t *message)
             if (!self->test)
                 topologyresolver_set_endpoint (self->resolver, endpoint);
             self->endpoint = strdup(endpoint);
+            s_info_invalidate (self, "endpoint");
             log_debug ("fty-info: CONNECT: %s/%s", self->endpoint, self->name);
             int rv = mlm_client_connect (self->client, self->endpoint, 1000, self->name);
             if (rv == -1)
@@ -299,6 +744,7 @@ s_handle_pipe(fty_info_server_t* self,zmsg_t *message)
 
         if (path) {
             self->path = strdup(path);
+            s_info_invalidate (self, "path");
             log_debug ("fty-info: PATH: %s", self->path);
         }
         zstr_free (&path);
@@ -348,6 +794,10 @@ s_handle_pipe(fty_info_server_t* self,zmsg_t *message)
             if (rv == -1)
                 log_error ("%s: can't set producer on stream '%s'",
                         self->name, stream);
+            else
+            if (streq (stream, FTY_PROTO_STREAM_METRICS))
+                // each metrics cycle is also pushed as one message
+                metricpublisher_set_stream (self->publisher, self->client);
         }
         zstr_free (&stream);
     }
@@ -355,8 +805,145 @@ s_handle_pipe(fty_info_server_t* self,zmsg_t *message)
         char *interval = zmsg_popstr (message);
         log_info ("Will be publishing metrics each %s seconds", interval);
         self->linuxmetrics_interval = (int) strtol (interval, NULL, 10);
+        metricpublisher_set_interval (self->publisher, self->linuxmetrics_interval);
+        if (self->linuxmetrics_interval > 0)
+            metricscheduler_start (self->scheduler, self->linuxmetrics_interval * 1000, zclock_mono ());
+        else
+            metricscheduler_stop (self->scheduler);
+        zstr_free (&interval);
+    }
+    else if (streq (command, "ANNOUNCEINTERVAL")) {
+        // ANNOUNCEINTERVAL/seconds, period of re-announcement, 0 disables it
+        char *interval = zmsg_popstr (message);
+        if (interval) {
+            int seconds = (int) strtol (interval, NULL, 10);
+            log_info ("Will be re-announcing each %s seconds", interval);
+            if (seconds > 0)
+                metricscheduler_start (self->announce_scheduler, seconds * 1000, zclock_mono ());
+            else
+                metricscheduler_stop (self->announce_scheduler);
+        }
+        else
+            log_error ("%s: interval missing", command);
         zstr_free (&interval);
     }
+    else if (streq (command, "TOPOLOGYCACHE")) {
+        // TOPOLOGYCACHE/count, bound of assets cached while resolving topology
+        char *count = zmsg_popstr (message);
+        if (count) {
+            long size = strtol (count, NULL, 10);
+            topologyresolver_set_cache_size (self->resolver, size > 0 ? (size_t) size : DEFAULT_TOPOLOGY_CACHE_SIZE);
+        }
+        else
+            log_error ("%s: count missing", command);
+        zstr_free (&count);
+    }
+    else if (streq (command, "ANNOUNCEDELTA")) {
+        // ANNOUNCEDELTA/count, deltas between full announcements, 0 disables deltas
+        char *count = zmsg_popstr (message);
+        if (count) {
+            self->announce_full_every = (int) strtol (count, NULL, 10);
+            self->announce_full_needed = true;
+            log_info ("Will be announcing %s",
+                self->announce_full_every > 0 ? "changes only" : "full information");
+        }
+        else
+            log_error ("%s: count missing", command);
+        zstr_free (&count);
+    }
+    else if (streq (command, "ANNOUNCEDEBOUNCE")) {
+        // ANNOUNCEDEBOUNCE/quiet ms/max delay ms, quiet 0 announces every change at once
+        char *quiet = zmsg_popstr (message);
+        char *max_delay = zmsg_popstr (message);
+        if (quiet && max_delay) {
+            self->announce_quiet = (int) strtol (quiet, NULL, 10);
+            self->announce_max_delay = (int) strtol (max_delay, NULL, 10);
+            log_info ("Will be announcing changes after %s ms quiet period, at most %s ms late", quiet, max_delay);
+        }
+        else
+            log_error ("%s: quiet period or max delay missing", command);
+        zstr_free (&max_delay);
+        zstr_free (&quiet);
+    }
+    else if (streq (command, "TIMERSLACK")) {
+        // TIMERSLACK/ms, allowed delay of metrics ticks to coalesce wakeups
+        char *slack = zmsg_popstr (message);
+        if (slack) {
+            log_info ("Will be using timer slack of %s ms", slack);
+            metricscheduler_set_slack (self->scheduler, (int) strtol (slack, NULL, 10));
+        }
+        else
+            log_error ("%s: slack missing", command);
+        zstr_free (&slack);
+    }
+    else if (streq (command, "METRICSOUTPUT")) {
+        // shm, stream or both; stream needs PRODUCER on METRICS stream
+        char *output = zmsg_popstr (message);
+        if (output && (streq (output, "shm") || streq (output, "stream") || streq (output, "both"))) {
+            log_info ("Will be publishing metrics to %s", output);
+            metricpublisher_set_shm (self->publisher, !streq (output, "stream"));
+            if (streq (output, "shm"))
+                metricpublisher_set_stream (self->publisher, NULL);
+        }
+        else
+            log_error ("%s: unknown output '%s'", command, output ? output : "(null)");
+        zstr_free (&output);
+    }
+    else if (streq (command, "METRICPOLICY")) {
+        // METRICPOLICY/type/policy[:threshold]
+        char *type = zmsg_popstr (message);
+        char *policy_str = zmsg_popstr (message);
+        metric_policy_t policy;
+        double threshold = 0;
+        char *threshold_str = policy_str ? strchr (policy_str, ':') : NULL;
+        if (threshold_str) {
+            *threshold_str = '\0';
+            threshold = strtod (threshold_str + 1, NULL);
+        }
+        if (type && metricpublisher_policy_from_str (policy_str, &policy) == 0) {
+            log_info ("Metric %s will be published with policy %s (%lf)", type, policy_str, threshold);
+            metricpublisher_set_policy (self->publisher, type, policy, threshold);
+        }
+        else
+            log_error ("%s: invalid policy for metric %s", command, type ? type : "(null)");
+        zstr_free (&policy_str);
+        zstr_free (&type);
+    }
+    else if (streq (command, "METRICPRECISION")) {
+        // METRICPRECISION/unit/digits, digits -1 means shortest round trip
+        char *unit = zmsg_popstr (message);
+        char *digits = zmsg_popstr (message);
+        if (unit && digits) {
+            log_info ("Metrics in %s will be published with precision %s", unit, digits);
+            metricpublisher_set_precision (self->publisher, unit, (int) strtol (digits, NULL, 10));
+        }
+        else
+            log_error ("%s: missing unit or digits", command);
+        zstr_free (&digits);
+        zstr_free (&unit);
+    }
+    else if (streq (command, "METRICSSOCKET")) {
+        // METRICSSOCKET/path, empty path disables the exposition
+        char *path = zmsg_popstr (message);
+        metricsexporter_destroy (&self->exporter);
+        if (path && !streq (path, ""))
+            self->exporter = metricsexporter_new (path);
+        zstr_free (&path);
+    }
+    else if (streq (command, "RELEASE_DETAILS")) {
+        char *path = zmsg_popstr (message);
+        if (path) {
+            log_debug ("fty-info: RELEASE_DETAILS: %s", path);
+            releasedetails_set_path (self->details, path);
+            inputwatcher_add (self->watcher, INPUT_RELEASE_DETAILS, path);
+            s_info_invalidate (self, "release details path");
+        }
+        zstr_free (&path);
+    }
+    else if (streq (command, "INVALIDATE")) {
+        // some input of INFO changed outside of agent's sight
+        s_info_invalidate (self, "request");
+    }
     else if (streq (command, "ROOT_DIR")) {
         char *root_dir = zmsg_popstr (message);
         log_info ("Will be using %s as root dir for finding out Linux metrics", root_dir);
@@ -373,9 +960,23 @@ s_handle_pipe(fty_info_server_t* self,zmsg_t *message)
         s_publish_linuxmetrics (self);
     }
     else if (streq (command, "CONFIG")) {
+        zstr_free (&self->hw_cap_path);
         self->hw_cap_path = zmsg_popstr (message);
         if (!self->hw_cap_path)
             log_error ("%s: hw_cap_path missing", command);
+        else {
+            char *file = zsys_sprintf ("%s/%s", self->hw_cap_path, HW_CAP_FILE);
+            inputwatcher_add (self->watcher, INPUT_HW_CAP, file);
+            hwcap_load (self->hwcap, file);
+            zstr_free (&file);
+        }
+    }
+    else if (streq (command, "CONFIG_FILE")) {
+        // changes of agent's config file are reported back on pipe
+        char *file = zmsg_popstr (message);
+        if (file)
+            inputwatcher_add (self->watcher, INPUT_CONFIG, file);
+        zstr_free (&file);
     }
     else
         log_error ("fty-info: Unknown actor command: %s.\n", command);
@@ -395,101 +996,59 @@ void fty_msg_free_fn(void *data)
 }
 
 //  --------------------------------------------------------------------------
-// return zmsg_t with hw capability info or NULL if info cannot be retrieved
-static zmsg_t*
-s_hw_cap (fty_info_server_t *self, const char *type, char *zuuid)
+//  Read iname and operation from header of encoded ASSET message without
+//  decoding it; return false if the message is not an ASSET one
+static bool
+s_peek_asset (zmsg_t *message, std::string &iname, std::string &operation)
 {
-    zmsg_t *msg = zmsg_new ();
-    char *tmp = zsys_sprintf ("%s/%s", self->hw_cap_path, HW_CAP_FILE);
-    zconfig_t *cap = zconfig_load (tmp);
-    zstr_free (&tmp);
-
-    if (!cap)
-    {
-        log_debug ("s_hw_cap: cannot load capability file from %s", self->hw_cap_path);
-        return msg;
-    }
-
-    if (streq (type, "gpi") || streq (type, "gpo"))
-    {
-        char *path = zsys_sprintf ("hardware/%s/count", type);
-        const char *count = s_get (cap, path, "");
-        zstr_free (&path);
-
-        zmsg_addstr (msg, zuuid);
-        zmsg_addstr (msg, "OK");
-        zmsg_addstr (msg, type);
-        zmsg_addstr (msg, count);
-        if (streq (count, "0"))
-            goto out;
-
-        path = zsys_sprintf ("hardware/%s/base_address", type);
-        const char *ba = s_get (cap, path, "");
-        zstr_free (&path);
-        zmsg_addstr (msg, ba);
-
-        path = zsys_sprintf ("hardware/%s/offset", type);
-        const char *offset = s_get (cap, path, "");
-        zstr_free (&path);
-        zmsg_addstr (msg, offset);
-
-        path = zsys_sprintf ("hardware/%s/mapping", type);
-        zconfig_t *ret = zconfig_locate (cap, path);
-        zstr_free (&path);
-
-        if (ret)
-        {
-            ret = zconfig_child (ret);
-            while (ret != NULL)
-            {
-                zmsg_addstr (msg, zconfig_name (ret));
-                zmsg_addstr (msg, zconfig_value (ret));
-
-                ret = zconfig_next (ret);
-            }
-            zconfig_destroy (&ret);
-        }
-    }
-    else
-    if (streq (type, "serial"))
-    {
-        // not implemented yet
-    }
-    else
-    if (streq (type, "type"))
-    {
-        zmsg_addstr (msg, zuuid);
-        zmsg_addstr (msg, "OK");
-        zmsg_addstr (msg, type);
-        zmsg_addstr (msg, s_get (cap, "hardware/type", ""));
-    }
-    else
-    {
-        log_info ("s_hw_cap: unsuported request for '%s'", type);
-
-        zmsg_addstr (msg, zuuid);
-        zmsg_addstr (msg, "ERROR");
-        zmsg_addstr (msg, "unsupported type");
+    zframe_t *frame = zmsg_first (message);
+    if (!frame)
+        return false;
+    const byte *data = zframe_data (frame);
+    size_t size = zframe_size (frame);
+    // signature (2 bytes) and id (1 byte), then name and operation as
+    // strings prefixed by 1 byte length
+    if (size < 3 || data [2] != FTY_PROTO_ASSET)
+        return false;
+    size_t offset = 3;
+    std::string *fields [2] = { &iname, &operation };
+    for (int i = 0; i < 2; i++) {
+        if (offset >= size || offset + 1 + data [offset] > size)
+            return false;
+        fields [i]->assign ((const char *) data + offset + 1, data [offset]);
+        offset += 1 + data [offset];
     }
-
-out:
-    zconfig_destroy (&cap);
-    return msg;
+    return true;
 }
 
-
 //  --------------------------------------------------------------------------
 //  process message from FTY_PROTO_ASSET stream
 void static
-s_handle_stream (fty_info_server_t* self, zmsg_t *message)
+s_handle_stream (fty_info_server_t* self, zmsg_t *message, const char *subject)
 {
+    // drop assets resolver does not care about before decoding them,
+    // subject is type.subtype@iname
+    const char *at = subject ? strrchr (subject, '@') : NULL;
+    if (at && !topologyresolver_wants (self->resolver, at + 1, NULL)) {
+        self->assets_dropped++;
+        zmsg_destroy (&message);
+        return;
+    }
     if (!is_fty_proto (message)){
         zmsg_destroy (&message);
         return;
     }
+    std::string iname, operation;
+    if (s_peek_asset (message, iname, operation)
+    &&  !topologyresolver_wants (self->resolver, iname.c_str (), operation.c_str ())) {
+        self->assets_dropped++;
+        zmsg_destroy (&message);
+        return;
+    }
+    self->assets_decoded++;
     fty_proto_t *bmessage = fty_proto_decode (&message);
     if (!bmessage ) {
-        log_error ("can't decode message with subject %s, ignoring", mlm_client_subject (self->client));
+        log_error ("can't decode message with subject %s, ignoring", subject);
         zmsg_destroy (&message);
         return;
     }
@@ -500,7 +1059,7 @@ s_handle_stream (fty_info_server_t* self, zmsg_t *message)
 
     }
     if(topologyresolver_asset (self->resolver, bmessage)) {
-        s_publish_announce(self);
+        s_announce_later (self);
     }
 
     fty_proto_destroy (&bmessage);
@@ -508,16 +1067,107 @@ s_handle_stream (fty_info_server_t* self, zmsg_t *message)
 
 }
 
+//  --------------------------------------------------------------------------
+//  asset agent replied to resolver, snapshot follows resolver version
+static void
+s_resolver_changed (topologyresolver_t *resolver, bool resolved, void *arg)
+{
+    fty_info_server_t *self = (fty_info_server_t *) arg;
+    if (resolved)
+        s_announce_later (self);
+}
+
+//  --------------------------------------------------------------------------
+//  Return the nearer of two poll timeouts, -1 means no timeout
+static int
+s_poll_timeout (int timeout1, int timeout2)
+{
+    if (timeout1 == -1)
+        return timeout2;
+    if (timeout2 == -1)
+        return timeout1;
+    return timeout1 < timeout2 ? timeout1 : timeout2;
+}
+
+static zmsg_t *
+s_handle_batch (fty_info_server_t *self, zmsg_t *message, const char *zuuid, const char *sender);
+
+//  --------------------------------------------------------------------------
+//  Return index of statistics of mailbox request
+static size_t
+s_stats_index (zmsg_t *message)
+{
+    zframe_t *command = zmsg_first (message);
+    for (size_t i = 0; command && i < STATS_COMMANDS - 1; i++) {
+        if (zframe_streq (command, s_stats_commands [i]))
+            return i;
+    }
+    return STATS_COMMANDS - 1;
+}
+
+//  --------------------------------------------------------------------------
+//  Account reply to mailbox request sent after latency us
+static void
+s_stats_reply (fty_info_server_t *self, size_t index, int64_t latency)
+{
+    mailbox_stats_t *stats = &self->stats [index];
+    size_t bucket = 0;
+    while (bucket < LATENCY_BOUNDS && latency > s_latency_bounds [bucket])
+        bucket++;
+    stats->replies.fetch_add (1, std::memory_order_relaxed);
+    stats->latency_sum.fetch_add ((uint64_t) latency, std::memory_order_relaxed);
+    stats->latency_buckets [bucket].fetch_add (1, std::memory_order_relaxed);
+}
+
+//  --------------------------------------------------------------------------
+//  create reply to STATS request
+//    - STATS
+//    - upper bounds of latency buckets [us], separated by space
+//  followed for every command by
+//    - command ("other" for unknown ones)
+//    - requests
+//    - replies
+//    - sum of reply latencies [us]
+//    - replies in latency buckets, cumulative, separated by space
+static zmsg_t *
+s_stats_msg (fty_info_server_t *self)
+{
+    zmsg_t *msg = zmsg_new ();
+    zmsg_addstr (msg, "STATS");
+    std::string bounds;
+    for (size_t j = 0; j < LATENCY_BOUNDS; j++)
+        bounds.append (std::to_string (s_latency_bounds [j])).append (" ");
+    bounds.append ("+Inf");
+    zmsg_addstr (msg, bounds.c_str ());
+
+    for (size_t i = 0; i < STATS_COMMANDS; i++) {
+        mailbox_stats_t *stats = &self->stats [i];
+        zmsg_addstr (msg, s_stats_commands [i]);
+        zmsg_addstrf (msg, "%llu", (unsigned long long) stats->requests.load (std::memory_order_relaxed));
+        zmsg_addstrf (msg, "%llu", (unsigned long long) stats->replies.load (std::memory_order_relaxed));
+        zmsg_addstrf (msg, "%llu", (unsigned long long) stats->latency_sum.load (std::memory_order_relaxed));
+        std::string buckets;
+        uint64_t cumulative = 0;
+        for (size_t j = 0; j <= LATENCY_BOUNDS; j++) {
+            cumulative += stats->latency_buckets [j].load (std::memory_order_relaxed);
+            buckets.append (j ? " " : "").append (std::to_string (cumulative));
+        }
+        zmsg_addstr (msg, buckets.c_str ());
+    }
+    return msg;
+}
+
 //  --------------------------------------------------------------------------
 //  process message from MAILBOX DELIVER
-void static
-s_handle_mailbox(fty_info_server_t* self,zmsg_t *message)
+//  Return reply for sender, or NULL if there is none
+static zmsg_t *
+s_handle_mailbox(fty_info_server_t* self, zmsg_t *message, const char *sender)
 {
     char *command = zmsg_popstr (message);
     if (!command) {
         zmsg_destroy (&message);
         log_warning ("Empty command.");
-        return;
+        return NULL;
     }
 
     char *zuuid = zmsg_popstr (message);
@@ -525,38 +1175,78 @@ s_handle_mailbox(fty_info_server_t* self,zmsg_t *message)
 
     //we assume all request command are MAILBOX DELIVER, and with any subject"
     if (streq (command, "INFO")) {
-        ftyinfo_t *info = ftyinfo_new (self->resolver,self->path);
-
-        reply = s_create_info (info);
+        reply = s_info_msg (self);
+        zmsg_pushstrf (reply, "%s", zuuid);
+    }
+    else
+    if (streq (command, "INFO-IF-CHANGED")) {
+        // client's tag of last seen version, full reply carries the new one
+        char *tag = zmsg_popstr (message);
+        s_info (self);
+        if (tag && streq (tag, self->info_tag)) {
+            reply = zmsg_new ();
+            zmsg_addstr (reply, "NOT-MODIFIED");
+        }
+        else {
+            reply = s_info_msg (self);
+            zmsg_addstr (reply, self->info_tag);
+        }
+        zmsg_pushstrf (reply, "%s", zuuid);
+        zstr_free (&tag);
+    }
+    else
+    if (streq (command, "INFO-FIELDS")) {
+        // only requested keys, straight from the snapshot
+        ftyinfo_t *info = s_info (self);
+        reply = zmsg_new ();
+        zmsg_addstr (reply, "INFO-FIELDS");
+        char *key = zmsg_popstr (message);
+        while (key) {
+            const char *value = ftyinfo_field (info, key);
+            if (value) {
+                zmsg_addstr (reply, key);
+                zmsg_addstr (reply, value);
+            }
+            zstr_free (&key);
+            key = zmsg_popstr (message);
+        }
+        zmsg_pushstrf (reply, "%s", zuuid);
+    }
+    else
+    if (streq (command, "STATS")) {
+        reply = s_stats_msg (self);
+        zmsg_pushstrf (reply, "%s", zuuid);
+    }
+    else
+    if (streq (command, "BATCH")) {
+        reply = s_handle_batch (self, message, zuuid, sender);
         zmsg_pushstrf (reply, "%s", zuuid);
-        ftyinfo_destroy (&info);
     }
     else
     if (streq (command, "INFO-TEST")) {
         ftyinfo_t *info = ftyinfo_test_new ();
 
-        reply = s_create_info (info);
+        reply = s_create_info (info, NULL);
         zmsg_pushstrf (reply, "%s", zuuid);
         ftyinfo_destroy (&info);
     }
     else
     if (streq (command, "HW_CAP")) {
         char *type = zmsg_popstr (message);
-        if (type)
-            reply = s_hw_cap (self, type, zuuid);
-
-        if (zmsg_size (reply) == 0)
+        reply = hwcap_reply (self->hwcap, type);
+        if (!reply)
         {
-            zmsg_pushstrf (reply, "%s", zuuid);
+            reply = zmsg_new ();
             zmsg_addstr (reply, "ERROR");
             zmsg_addstr (reply, "cap does not exist");
         }
+        zmsg_pushstrf (reply, "%s", zuuid);
         zstr_free (&type);
     }
     else
     if (streq (command, "ERROR")) {
         // Don't reply to ERROR messages
-        log_warning ("%s: Received ERROR command from '%s', ignoring", self->name, mlm_client_sender (self->client));
+        log_warning ("%s: Received ERROR command from '%s', ignoring", self->name, sender);
     }
     else {
         log_warning ("%s: Received unexpected command '%s'", self->name, command);
@@ -569,24 +1259,140 @@ s_handle_mailbox(fty_info_server_t* self,zmsg_t *message)
         zmsg_addstr (reply, "unexpected command");
     }
 
-    if (reply) {
-        int rv = mlm_client_sendto (self->client,
-                                    mlm_client_sender (self->client),
-                                    "info",
-                                    NULL,
-                                    1000,
-                                    &reply);
-        if (rv != 0)
-            log_error ("s_handle_mailbox: failed to send reply to %s ", mlm_client_sender (self->client));
-    }
-
     zstr_free (&zuuid);
     zstr_free (&command);
     zmsg_destroy (&message);
 
-    return;
+    return reply;
+
+}
+
+//  --------------------------------------------------------------------------
+//  run requests of BATCH/uuid/cmd/args.../;/cmd/args... and return
+//    - BATCH
+//    - number of items
+//  followed for every item by
+//    - status (OK or ERROR)
+//    - number of frames of item's reply
+//    - frames of reply, as it would be without correlation id
+static zmsg_t *
+s_handle_batch (fty_info_server_t *self, zmsg_t *message, const char *zuuid, const char *sender)
+{
+    zmsg_t *items = zmsg_new ();
+    size_t count = 0;
+    char *frame = zmsg_popstr (message);
+    while (frame) {
+        // collect one item up to separator
+        zmsg_t *request = zmsg_new ();
+        char *command = frame;
+        frame = zmsg_popstr (message);
+        while (frame && !streq (frame, ";")) {
+            zmsg_addstr (request, frame);
+            zstr_free (&frame);
+            frame = zmsg_popstr (message);
+        }
+        zstr_free (&frame);
+        frame = zmsg_popstr (message);
+
+        zmsg_t *item = NULL;
+        if (streq (command, "BATCH") || streq (command, "ERROR")) {
+            zmsg_destroy (&request);
+            item = zmsg_new ();
+            zmsg_addstr (item, "ERROR");
+            zmsg_addstr (item, "not allowed in batch");
+        }
+        else {
+            // request is destroyed by the handler
+            zmsg_pushstrf (request, "%s", zuuid ? zuuid : "");
+            zmsg_pushstr (request, command);
+            item = s_handle_mailbox (self, request, sender);
+            if (item) {
+                // correlation id is on the whole batch
+                char *id = zmsg_popstr (item);
+                zstr_free (&id);
+            }
+        }
+        zstr_free (&command);
+
+        zframe_t *first = item ? zmsg_first (item) : NULL;
+        zmsg_addstr (items, !item || (first && zframe_streq (first, "ERROR")) ? "ERROR" : "OK");
+        zmsg_addstrf (items, "%zu", item ? zmsg_size (item) : (size_t) 0);
+        while (item && zmsg_size (item)) {
+            zframe_t *part = zmsg_pop (item);
+            zmsg_append (items, &part);
+        }
+        zmsg_destroy (&item);
+        count++;
+    }
 
+    zmsg_pushstrf (items, "%zu", count);
+    zmsg_pushstr (items, "BATCH");
+    return items;
 }
+
+//  --------------------------------------------------------------------------
+//  receive all pending messages of client. Mailbox requests are answered
+//  together, so a burst of them shares one INFO snapshot and replies are
+//  sent back to back.
+static void
+s_handle_client (fty_info_server_t *self)
+{
+    struct request_t {
+        char *sender;
+        zmsg_t *message;
+        int64_t received;
+        size_t stats;
+    };
+    std::vector<request_t> requests;
+    zsock_t *msgpipe = mlm_client_msgpipe (self->client);
+
+    for (int count = 0; count < CLIENT_DRAIN_MAX; count++) {
+        if (count && !(zsock_events (msgpipe) & ZMQ_POLLIN))
+            break;
+        zmsg_t *message = mlm_client_recv (self->client);
+        if (!message)
+            break;
+        const char *command = mlm_client_command (self->client);
+        if (streq (command, "STREAM DELIVER")) {
+            s_handle_stream (self, message, mlm_client_subject (self->client));
+        }
+        else
+        if (streq (command, "MAILBOX DELIVER")) {
+            request_t request = { strdup (mlm_client_sender (self->client)), message, zclock_usecs (), s_stats_index (message) };
+            self->stats [request.stats].requests.fetch_add (1, std::memory_order_relaxed);
+            requests.push_back (request);
+        }
+        else
+            zmsg_destroy (&message);
+    }
+    if (requests.empty ())
+        return;
+
+    self->mailbox_wakeups++;
+    self->mailbox_requests += requests.size ();
+    if (requests.size () > self->mailbox_drained_max)
+        self->mailbox_drained_max = requests.size ();
+    if (requests.size () > 1)
+        log_debug ("answering %zu mailbox requests at once", requests.size ());
+
+    std::vector<zmsg_t *> replies;
+    for (auto &request : requests)
+        replies.push_back (s_handle_mailbox (self, request.message, request.sender));
+
+    for (size_t i = 0; i < requests.size (); i++) {
+        if (replies [i]) {
+            int rv = mlm_client_sendto (self->client, requests [i].sender, "info", NULL, 1000, &replies [i]);
+            if (rv != 0)
+                log_error ("s_handle_mailbox: failed to send reply to %s ", requests [i].sender);
+            int64_t latency = zclock_usecs () - requests [i].received;
+            s_stats_reply (self, requests [i].stats, latency);
+            if (latency > self->reply_latency_max)
+                self->reply_latency_max = latency;
+        }
+        zstr_free (&requests [i].sender);
+    }
+}
+
 //  --------------------------------------------------------------------------
 //  Create a new fty_info_server
 
@@ -600,8 +1406,19 @@ fty_info_server (zsock_t *pipe, void *args)
     }
 
     fty_info_server_t *self = info_server_new (name);
-    zpoller_t *poller = zpoller_new (pipe, mlm_client_msgpipe (self->client), NULL);
-    assert (poller);
+    topologyresolver_set_callback (self->resolver, s_resolver_changed, self);
+    // zpoller can't wait on timerfd, so poll sockets and descriptors directly
+    enum { POLL_PIPE, POLL_CLIENT, POLL_TIMER, POLL_EXPORTER, POLL_WATCHER, POLL_ADDRS, POLL_ANNOUNCE, POLL_RESOLVER, POLL_SIZE };
+    zmq_pollitem_t items [POLL_SIZE] = {
+        { zsock_resolve (pipe), 0, ZMQ_POLLIN, 0 },
+        { zsock_resolve (mlm_client_msgpipe (self->client)), 0, ZMQ_POLLIN, 0 },
+        { NULL, metricscheduler_fd (self->scheduler), ZMQ_POLLIN, 0 },
+        { NULL, -1, ZMQ_POLLIN, 0 },
+        { NULL, inputwatcher_fd (self->watcher), ZMQ_POLLIN, 0 },
+        { NULL, localaddrs_fd (self->localaddrs), ZMQ_POLLIN, 0 },
+        { NULL, metricscheduler_fd (self->announce_scheduler), ZMQ_POLLIN, 0 },
+        { zsock_resolve (topologyresolver_msgpipe (self->resolver)), 0, ZMQ_POLLIN, 0 }
+    };
 
     zsock_signal (pipe, 0);
     log_info ("fty-info: Started");
@@ -609,38 +1426,187 @@ fty_info_server (zsock_t *pipe, void *args)
 
     while (!zsys_interrupted)
     {
-        void *which = zpoller_wait (poller, TIMEOUT_MS);
-        if (which == NULL) {
-            if (zpoller_terminated (poller) || zsys_interrupted) {
-                break;
-            }
+        // exporter can be (re)created by pipe command
+        items [POLL_EXPORTER].fd = self->exporter ? metricsexporter_fd (self->exporter) : -1;
+        items [POLL_EXPORTER].revents = 0;
+        int64_t now = zclock_mono ();
+        int timeout = s_poll_timeout (s_announce_timeout (self, now), topologyresolver_timeout (self->resolver, now));
+        if (zmq_poll (items, POLL_SIZE, timeout == -1 ? TIMEOUT_MS : timeout) == -1) {
+            if (errno == EINTR && !zsys_interrupted)
+                continue;
+            break;
+        }
+        if (items [POLL_RESOLVER].revents & ZMQ_POLLIN)
+            topologyresolver_recv (self->resolver);
+        topologyresolver_expire (self->resolver, zclock_mono ());
+        if (s_announce_timeout (self, zclock_mono ()) == 0)
+            s_publish_announce (self);
+        if (items [POLL_ANNOUNCE].revents & ZMQ_POLLIN) {
+            if (metricscheduler_expire (self->announce_scheduler, zclock_mono ()))
+                s_reannounce (self);
+        }
+        if (items [POLL_TIMER].revents & ZMQ_POLLIN) {
+            if (metricscheduler_expire (self->scheduler, zclock_mono ()))
+                s_publish_linuxmetrics (self);
         }
-        if (which == pipe) {
+        if (items [POLL_WATCHER].revents & ZMQ_POLLIN)
+            s_handle_inputs (self, pipe, inputwatcher_read (self->watcher));
+        if (items [POLL_ADDRS].revents & ZMQ_POLLIN) {
+            if (localaddrs_update (self->localaddrs))
+                s_info_invalidate (self, "local addresses changed");
+        }
+        if (self->exporter && (items [POLL_EXPORTER].revents & ZMQ_POLLIN))
+            s_export_metrics (self);
+        if (items [POLL_PIPE].revents & ZMQ_POLLIN) {
             log_trace ("which == pipe");
             if(!s_handle_pipe(self,zmsg_recv (pipe)))
                 break;//TERM
             else continue;
         }
-        else
-        if (which == mlm_client_msgpipe (self->client)) {
-            zmsg_t *message = mlm_client_recv (self->client);
-            if (!message)
-                continue;
-            const char *command = mlm_client_command (self->client);
-            if (streq (command, "STREAM DELIVER")) {
-                s_handle_stream (self, message);
-            }
-            else
-            if (streq (command, "MAILBOX DELIVER")) {
-                s_handle_mailbox (self, message);
-            }
-        }
+        if (items [POLL_CLIENT].revents & ZMQ_POLLIN)
+            s_handle_client (self);
     }
 
-    zpoller_destroy (&poller);
     info_server_destroy(&self);
 }
 
+//  --------------------------------------------------------------------------
+//  Return server which publishes announcements on ANNOUNCE stream, for
+//  tests driving it without actor
+
+static fty_info_server_t *
+s_test_announcer (const char *endpoint, const char *name)
+{
+    fty_info_server_t *self = info_server_new ((char *) name);
+    int rv = mlm_client_connect (self->announce_client, endpoint, 1000, name);
+    assert (rv == 0);
+    rv = mlm_client_set_producer (self->announce_client, "ANNOUNCE");
+    assert (rv == 0);
+    return self;
+}
+
+//  Return client consuming ANNOUNCE stream
+static mlm_client_t *
+s_test_listener (const char *endpoint, const char *name)
+{
+    mlm_client_t *listener = mlm_client_new ();
+    int rv = mlm_client_connect (listener, endpoint, 1000, name);
+    assert (rv == 0);
+    rv = mlm_client_set_consumer (listener, "ANNOUNCE", ".*");
+    assert (rv == 0);
+    return listener;
+}
+
+//  Return true if listener receives nothing within timeout (ms)
+static bool
+s_test_silent (mlm_client_t *listener, int timeout)
+{
+    zpoller_t *poller = zpoller_new (mlm_client_msgpipe (listener), NULL);
+    bool silent = zpoller_wait (poller, timeout) == NULL;
+    zpoller_destroy (&poller);
+    return silent;
+}
+
+//  Write release details with uuid and optional part number, as new file
+static void
+s_test_release_details (const char *path, const char *uuid, const char *part_number)
+{
+    char *tmp = zsys_sprintf ("%s.new", path);
+    FILE *f = fopen (tmp, "w");
+    assert (f);
+    fprintf (f, "{ \"release-details\": { \"uuid\": \"%s\"", uuid);
+    if (part_number)
+        fprintf (f, ", \"hardware-part-number\": \"%s\"", part_number);
+    fprintf (f, " } }\n");
+    fclose (f);
+    int rv = rename (tmp, path);
+    assert (rv == 0);
+    zstr_free (&tmp);
+}
+
+//  Change path reported in INFO
+static void
+s_test_set_path (fty_info_server_t *self, const char *path)
+{
+    zstr_free (&self->path);
+    self->path = strdup (path);
+    s_info_invalidate (self, "path");
+}
+
+//  Receive announcement, check its subject and command and return the
+//  frames after the command
+static zmsg_t *
+s_test_announce (mlm_client_t *listener, const char *subject, const char *command)
+{
+    zmsg_t *recv = mlm_client_recv (listener);
+    assert (recv);
+    assert (streq (mlm_client_subject (listener), subject));
+    char *value = zmsg_popstr (recv);
+    assert (streq (value, command));
+    zstr_free (&value);
+    return recv;
+}
+
+//  Receive full announcement with sequence number as the last frame and
+//  return its hashtable
+static zhash_t *
+s_test_full_announce (mlm_client_t *listener, const char *subject, const char *seq)
+{
+    zmsg_t *recv = s_test_announce (listener, subject, FTY_INFO_CMD);
+    // name, type, subtype and port, then hashtable and sequence number
+    assert (zmsg_size (recv) == 6);
+    char *last = zframe_strdup (zmsg_last (recv));
+    assert (streq (last, seq));
+    zstr_free (&last);
+    for (int i = 0; i < 4; i++) {
+        char *value = zmsg_popstr (recv);
+        zstr_free (&value);
+    }
+    zframe_t *frame = zmsg_pop (recv);
+    zhash_t *infos = zhash_unpack (frame);
+    assert (infos);
+    zframe_destroy (&frame);
+    zmsg_destroy (&recv);
+    return infos;
+}
+
+//  Receive delta announcement and return its hashtable of changed values,
+//  removed names are left in rest_p
+static zhash_t *
+s_test_delta_announce (mlm_client_t *listener, const char *seq, zmsg_t **rest_p)
+{
+    zmsg_t *recv = s_test_announce (listener, "UPDATE", "INFO-DELTA");
+    char *value = zmsg_popstr (recv);
+    assert (streq (value, seq));
+    zstr_free (&value);
+    zframe_t *frame = zmsg_pop (recv);
+    zhash_t *changed = zhash_unpack (frame);
+    assert (changed);
+    zframe_destroy (&frame);
+    *rest_p = recv;
+    return changed;
+}
+
+//  Return encoded ASSET message, parent is optional
+static zmsg_t *
+s_test_asset (const char *iname, const char *operation, const char *name, const char *parent)
+{
+    fty_proto_t *asset = fty_proto_new (FTY_PROTO_ASSET);
+    fty_proto_set_name (asset, "%s", iname);
+    fty_proto_set_operation (asset, "%s", operation);
+    zhash_t *ext = zhash_new ();
+    zhash_autofree (ext);
+    zhash_update (ext, "name", (void *) name);
+    fty_proto_set_ext (asset, &ext);
+    if (parent) {
+        zhash_t *aux = zhash_new ();
+        zhash_autofree (aux);
+        zhash_update (aux, "parent_name.1", (void *) parent);
+        fty_proto_set_aux (asset, &aux);
+    }
+    return fty_proto_encode (&asset);
+}
+
 //  --------------------------------------------------------------------------
 //  Self test of this class
 
@@ -661,6 +1627,74 @@ fty_info_server_test (bool verbose)
 
     //  @selftest
 
+    {
+        // change pending while announce client is not connected must not
+        // leave the debounce timeout expired
+        fty_info_server_t *self = info_server_new ((char *) "fty-info-disconnected");
+        s_announce_later (self);
+        int64_t due = zclock_mono () + self->announce_max_delay;
+        assert (s_announce_timeout (self, due) == 0);
+        s_publish_announce (self);
+        assert (s_announce_timeout (self, due) == -1);
+        assert (self->announce_full_needed);
+        info_server_destroy (&self);
+    }
+
+    {
+        // changed server/metrics_socket is sent on reload, empty one
+        // closes the exposition
+        zsys_dir_create (SELFTEST_DIR_RW);
+        char *path = zsys_sprintf ("%s/fty-info-metrics.sock", SELFTEST_DIR_RW);
+        fty_info_server_t *self = info_server_new ((char *) "fty-info-exporter");
+        zmsg_t *message = zmsg_new ();
+        zmsg_addstr (message, "METRICSSOCKET");
+        zmsg_addstr (message, path);
+        assert (s_handle_pipe (self, message));
+        assert (self->exporter);
+        assert (zsys_file_exists (path));
+        message = zmsg_new ();
+        zmsg_addstr (message, "METRICSSOCKET");
+        zmsg_addstr (message, "");
+        assert (s_handle_pipe (self, message));
+        assert (self->exporter == NULL);
+        assert (!zsys_file_exists (path));
+        info_server_destroy (&self);
+        zstr_free (&path);
+    }
+
+    {
+        // asset messages which can't change the topology are dropped
+        // before decoding, by subject or by header of encoded message
+        fty_info_server_t *self = info_server_new ((char *) "fty-info-assets");
+        s_handle_stream (self, s_test_asset (DEFAULT_RC_INAME, FTY_PROTO_ASSET_OP_CREATE, "rc", "room"), NULL);
+        s_handle_stream (self, s_test_asset ("room", FTY_PROTO_ASSET_OP_UPDATE, "my room", NULL), "room.N_A@room");
+        assert (self->assets_decoded == 2);
+        assert (self->assets_dropped == 0);
+        char *topology = topologyresolver_to_string (self->resolver);
+        assert (streq (topology, "my room"));
+        zstr_free (&topology);
+
+        s_handle_stream (self, s_test_asset ("ups-1", FTY_PROTO_ASSET_OP_UPDATE, "ups", NULL), NULL);
+        s_handle_stream (self, s_test_asset ("ups-1", FTY_PROTO_ASSET_OP_UPDATE, "ups", NULL), "device.ups@ups-1");
+        s_handle_stream (self, s_test_asset (DEFAULT_RC_INAME, "inventory", "rc", NULL), NULL);
+        assert (self->assets_decoded == 2);
+        assert (self->assets_dropped == 3);
+
+        // updates of this RC and its parents still reach the resolver
+        s_handle_stream (self, s_test_asset ("room", FTY_PROTO_ASSET_OP_UPDATE, "new room", NULL), NULL);
+        assert (self->assets_decoded == 3);
+        topology = topologyresolver_to_string (self->resolver);
+        assert (streq (topology, "new room"));
+        zstr_free (&topology);
+        s_handle_stream (self, s_test_asset (DEFAULT_RC_INAME, FTY_PROTO_ASSET_OP_UPDATE, "rc", "room"), "device.rackcontroller@" DEFAULT_RC_INAME);
+        assert (self->assets_decoded == 4);
+        assert (self->assets_dropped == 3);
+        topology = topologyresolver_to_string (self->resolver);
+        assert (streq (topology, "new room"));
+        zstr_free (&topology);
+        info_server_destroy (&self);
+    }
+
     static const char* endpoint = "inproc://fty-info-test";
 
     zactor_t *server = zactor_new (mlm_server, (void*) "Malamute");
@@ -669,6 +1703,177 @@ fty_info_server_test (bool verbose)
     mlm_client_t *client = mlm_client_new ();
     mlm_client_connect (client, endpoint, 1000, "fty_info_server_test");
 
+    {
+        // changes within quiet period are announced once
+        fty_info_server_t *self = s_test_announcer (endpoint, "fty-info-debounce");
+        mlm_client_t *listener = s_test_listener (endpoint, "fty-info-debounce-listener");
+        zmsg_t *message = zmsg_new ();
+        zmsg_addstr (message, "ANNOUNCEDEBOUNCE");
+        zmsg_addstr (message, "200");
+        zmsg_addstr (message, "300");
+        assert (s_handle_pipe (self, message));
+        uint64_t suppressed = self->announce_suppressed;
+        for (int i = 0; i < 5; i++)
+            s_announce_later (self);
+        assert (self->announce_suppressed == suppressed + 4);
+        int timeout;
+        while ((timeout = s_announce_timeout (self, zclock_mono ())) > 0)
+            zclock_sleep (timeout);
+        assert (timeout == 0);
+        s_publish_announce (self);
+        assert (s_announce_timeout (self, zclock_mono ()) == -1);
+        zmsg_t *recv = mlm_client_recv (listener);
+        assert (recv);
+        assert (streq (mlm_client_subject (listener), "CREATE"));
+        zmsg_destroy (&recv);
+        assert (s_test_silent (listener, 500));
+
+        // steady changes are announced at most max delay after the first one
+        s_announce_later (self);
+        zclock_sleep (150);
+        s_announce_later (self);
+        int64_t now = self->announce_last_change;
+        assert (now - self->announce_first_change > 100);
+        assert (s_announce_timeout (self, now) == (int) (self->announce_first_change + 300 - now));
+        assert (self->announce_suppressed == suppressed + 5);
+
+        mlm_client_destroy (&listener);
+        info_server_destroy (&self);
+    }
+
+    {
+        // delta announcements: full one first and then only changes
+        zsys_dir_create (SELFTEST_DIR_RW);
+        char *details = zsys_sprintf ("%s/announce-release-details.json", SELFTEST_DIR_RW);
+        s_test_release_details (details, "ce7c523e-08bf-11e7-af17-080027d52c4f", "123456");
+        fty_info_server_t *self = s_test_announcer (endpoint, "fty-info-delta");
+        mlm_client_t *listener = s_test_listener (endpoint, "fty-info-delta-listener");
+        releasedetails_set_path (self->details, details);
+        s_test_set_path (self, "/api/v1");
+        zmsg_t *message = zmsg_new ();
+        zmsg_addstr (message, "ANNOUNCEDELTA");
+        zmsg_addstr (message, "2");
+        assert (s_handle_pipe (self, message));
+
+        s_publish_announce (self);
+        zhash_t *infos = s_test_full_announce (listener, "CREATE", "1");
+        assert (streq ((char *) zhash_lookup (infos, INFO_REST_PATH), "/api/v1"));
+        assert (streq ((char *) zhash_lookup (infos, INFO_PART_NUMBER), "123456"));
+        zhash_destroy (&infos);
+
+        // changed value only
+        s_test_set_path (self, "/api/v2");
+        s_publish_announce (self);
+        zmsg_t *rest;
+        zhash_t *changed = s_test_delta_announce (listener, "2", &rest);
+        assert (zhash_size (changed) == 1);
+        assert (streq ((char *) zhash_lookup (changed, INFO_REST_PATH), "/api/v2"));
+        assert (zmsg_size (rest) == 0);
+        zhash_destroy (&changed);
+        zmsg_destroy (&rest);
+
+        // removed value only
+        s_test_release_details (details, "ce7c523e-08bf-11e7-af17-080027d52c4f", NULL);
+        s_info_invalidate (self, "release details");
+        s_publish_announce (self);
+        changed = s_test_delta_announce (listener, "3", &rest);
+        assert (zhash_size (changed) == 0);
+        assert (zmsg_size (rest) == 1);
+        char *removed = zmsg_popstr (rest);
+        assert (streq (removed, INFO_PART_NUMBER));
+        zstr_free (&removed);
+        zhash_destroy (&changed);
+        zmsg_destroy (&rest);
+
+        // full one after 2 deltas
+        s_test_set_path (self, "/api/v3");
+        s_publish_announce (self);
+        infos = s_test_full_announce (listener, "UPDATE", "4");
+        assert (streq ((char *) zhash_lookup (infos, INFO_REST_PATH), "/api/v3"));
+        assert (zhash_lookup (infos, INFO_PART_NUMBER) == NULL);
+        zhash_destroy (&infos);
+
+        s_test_set_path (self, "/api/v4");
+        s_publish_announce (self);
+        changed = s_test_delta_announce (listener, "5", &rest);
+        zhash_destroy (&changed);
+        zmsg_destroy (&rest);
+
+        // full one when uuid changes, even before 2 deltas
+        s_test_release_details (details, "0b7c58f2-1e5e-4f2a-9c0e-5a1d7e3b8c11", NULL);
+        s_info_invalidate (self, "release details");
+        s_publish_announce (self);
+        infos = s_test_full_announce (listener, "UPDATE", "6");
+        assert (streq ((char *) zhash_lookup (infos, INFO_UUID), "0b7c58f2-1e5e-4f2a-9c0e-5a1d7e3b8c11"));
+        zhash_destroy (&infos);
+
+        // full one after announcement which could not be published
+        mlm_client_destroy (&self->announce_client);
+        self->announce_client = mlm_client_new ();
+        s_test_set_path (self, "/api/v5");
+        s_publish_announce (self);
+        assert (self->announce_full_needed);
+        assert (s_test_silent (listener, 200));
+        int rv = mlm_client_connect (self->announce_client, endpoint, 1000, "fty-info-delta-2");
+        assert (rv == 0);
+        rv = mlm_client_set_producer (self->announce_client, "ANNOUNCE");
+        assert (rv == 0);
+        s_test_set_path (self, "/api/v6");
+        s_publish_announce (self);
+        infos = s_test_full_announce (listener, "UPDATE", "7");
+        assert (streq ((char *) zhash_lookup (infos, INFO_REST_PATH), "/api/v6"));
+        zhash_destroy (&infos);
+
+        mlm_client_destroy (&listener);
+        info_server_destroy (&self);
+        unlink (details);
+        zstr_free (&details);
+    }
+
+    {
+        // periodic re-announcement repeats the cached announcement
+        fty_info_server_t *self = s_test_announcer (endpoint, "fty-info-reannounce");
+        mlm_client_t *listener = s_test_listener (endpoint, "fty-info-reannounce-listener");
+        s_publish_announce (self);
+        zmsg_t *recv = mlm_client_recv (listener);
+        assert (recv && streq (mlm_client_subject (listener), "CREATE"));
+        zmsg_destroy (&recv);
+
+        zmsg_t *message = zmsg_new ();
+        zmsg_addstr (message, "ANNOUNCEINTERVAL");
+        zmsg_addstr (message, "1");
+        assert (s_handle_pipe (self, message));
+        zmq_pollitem_t item = { NULL, metricscheduler_fd (self->announce_scheduler), ZMQ_POLLIN, 0 };
+        bool ticked = false;
+        int64_t until = zclock_mono () + 3000;
+        while (!ticked && zclock_mono () < until) {
+            if (zmq_poll (&item, 1, 500) == 1)
+                ticked = metricscheduler_expire (self->announce_scheduler, zclock_mono ());
+        }
+        assert (ticked);
+        s_reannounce (self);
+        recv = mlm_client_recv (listener);
+        assert (recv && streq (mlm_client_subject (listener), "UPDATE"));
+        zmsg_t *cached = self->info_msg;
+        assert (zmsg_size (recv) == zmsg_size (cached));
+        zframe_t *frame = zmsg_first (recv);
+        for (zframe_t *expected = zmsg_first (cached); expected; expected = zmsg_next (cached)) {
+            assert (zframe_eq (frame, expected));
+            frame = zmsg_next (recv);
+        }
+        zmsg_destroy (&recv);
+
+        // 0 stops it
+        message = zmsg_new ();
+        zmsg_addstr (message, "ANNOUNCEINTERVAL");
+        zmsg_addstr (message, "0");
+        assert (s_handle_pipe (self, message));
+        assert (zmq_poll (&item, 1, 1500) == 0);
+
+        mlm_client_destroy (&listener);
+        info_server_destroy (&self);
+    }
+
 
     zactor_t *info_server = zactor_new (fty_info_server, (void*) "fty-info");
     zstr_sendx (info_server, "TEST", NULL);
@@ -800,6 +2005,86 @@ fty_info_server_test (bool verbose)
         zuuid_destroy (&zuuid);
         log_info ("fty-info-test:Test #2: OK");
     }
+    // Test #2b: conditional INFO request
+    {
+        log_debug ("fty-info-test:Test #2b");
+        zuuid_t *zuuid = zuuid_new ();
+        zmsg_t *request = zmsg_new ();
+        zmsg_addstr (request, "INFO-IF-CHANGED");
+        zmsg_addstr (request, zuuid_str_canonical (zuuid));
+        zmsg_addstr (request, "");
+        mlm_client_sendto (client, "fty-info", "INFO", NULL, 1000, &request);
+
+        // unknown version: full reply followed by version tag
+        zmsg_t *recv = mlm_client_recv (client);
+        assert (zmsg_size (recv) == 8);
+        char *zuuid_reply = zmsg_popstr (recv);
+        assert (zuuid_reply && streq (zuuid_str_canonical(zuuid), zuuid_reply));
+        char *cmd = zmsg_popstr (recv);
+        assert (cmd && streq (cmd, FTY_INFO_CMD));
+        zframe_t *frame_tag = zmsg_last (recv);
+        char *tag = zframe_strdup (frame_tag);
+        assert (tag && !streq (tag, ""));
+        zstr_free (&cmd);
+        zstr_free (&zuuid_reply);
+        zmsg_destroy (&recv);
+
+        // same version: only NOT-MODIFIED
+        request = zmsg_new ();
+        zmsg_addstr (request, "INFO-IF-CHANGED");
+        zmsg_addstr (request, zuuid_str_canonical (zuuid));
+        zmsg_addstr (request, tag);
+        mlm_client_sendto (client, "fty-info", "INFO", NULL, 1000, &request);
+
+        recv = mlm_client_recv (client);
+        assert (zmsg_size (recv) == 2);
+        zuuid_reply = zmsg_popstr (recv);
+        assert (zuuid_reply && streq (zuuid_str_canonical(zuuid), zuuid_reply));
+        cmd = zmsg_popstr (recv);
+        assert (cmd && streq (cmd, "NOT-MODIFIED"));
+        zstr_free (&cmd);
+        zstr_free (&zuuid_reply);
+        zstr_free (&tag);
+        zmsg_destroy (&recv);
+        zuuid_destroy (&zuuid);
+        log_info ("fty-info-test:Test #2b: OK");
+    }
+    // Test #2c: INFO with selected fields only
+    {
+        log_debug ("fty-info-test:Test #2c");
+        zuuid_t *zuuid = zuuid_new ();
+        zmsg_t *request = zmsg_new ();
+        zmsg_addstr (request, "INFO-FIELDS");
+        zmsg_addstr (request, zuuid_str_canonical (zuuid));
+        zmsg_addstr (request, INFO_HOSTNAME);
+        zmsg_addstr (request, "no-such-key");
+        zmsg_addstr (request, INFO_TXTVERS);
+        mlm_client_sendto (client, "fty-info", "INFO", NULL, 1000, &request);
+
+        zmsg_t *recv = mlm_client_recv (client);
+        assert (zmsg_size (recv) == 6);
+        char *zuuid_reply = zmsg_popstr (recv);
+        assert (zuuid_reply && streq (zuuid_str_canonical(zuuid), zuuid_reply));
+        char *cmd = zmsg_popstr (recv);
+        assert (cmd && streq (cmd, "INFO-FIELDS"));
+        char *key = zmsg_popstr (recv);
+        assert (key && streq (key, INFO_HOSTNAME));
+        zstr_free (&key);
+        char *value = zmsg_popstr (recv);
+        assert (value && !streq (value, ""));
+        zstr_free (&value);
+        key = zmsg_popstr (recv);
+        assert (key && streq (key, INFO_TXTVERS));
+        value = zmsg_popstr (recv);
+        assert (value && streq (value, TXT_VER));
+        zstr_free (&value);
+        zstr_free (&key);
+        zstr_free (&cmd);
+        zstr_free (&zuuid_reply);
+        zmsg_destroy (&recv);
+        zuuid_destroy (&zuuid);
+        log_info ("fty-info-test:Test #2c: OK");
+    }
     mlm_client_t *asset_generator = mlm_client_new ();
     mlm_client_connect (asset_generator, endpoint, 1000, "fty_info_asset_generator");
     mlm_client_set_producer (asset_generator, FTY_PROTO_STREAM_ASSETS);
@@ -1345,6 +2630,114 @@ fty_info_server_test (bool verbose)
         zmsg_destroy (&recv);
         log_info ("OK\n");
     }
+    {
+        // TEST #10b: several requests in one BATCH
+        log_info ("fty-info-test:Test #10b: batch");
+        zmsg_t *batch = zmsg_new ();
+        zmsg_addstr (batch, "BATCH");
+        zmsg_addstr (batch, "uuid1236");
+        zmsg_addstr (batch, "HW_CAP");
+        zmsg_addstr (batch, "type");
+        zmsg_addstr (batch, ";");
+        zmsg_addstr (batch, "INFO-FIELDS");
+        zmsg_addstr (batch, INFO_TXTVERS);
+        zmsg_addstr (batch, ";");
+        zmsg_addstr (batch, "FOO");
+
+        mlm_client_sendto (client, "fty-info", "info", NULL, 1000, &batch);
+
+        zmsg_t *recv = mlm_client_recv (client);
+        assert (recv);
+        const char *expected [] = {
+            "uuid1236", "BATCH", "3",
+            "OK", "3", "OK", "type", "ipc",
+            "OK", "3", "INFO-FIELDS", INFO_TXTVERS, TXT_VER,
+            "ERROR", "2", "ERROR", "unexpected command"
+        };
+        assert (zmsg_size (recv) == sizeof (expected) / sizeof (expected [0]));
+        for (size_t i = 0; i < sizeof (expected) / sizeof (expected [0]); i++) {
+            char *val = zmsg_popstr (recv);
+            assert (val && streq (val, expected [i]));
+            zstr_free (&val);
+        }
+        zmsg_destroy (&recv);
+        log_info ("OK\n");
+    }
+    {
+        log_info ("fty-info-test:Test #10c: stats");
+        zmsg_t *request = zmsg_new ();
+        zmsg_addstr (request, "STATS");
+        zmsg_addstr (request, "uuid1237");
+        mlm_client_sendto (client, "fty-info", "info", NULL, 1000, &request);
+
+        zmsg_t *recv = mlm_client_recv (client);
+        assert (recv);
+        assert (zmsg_size (recv) == 3 + 5 * STATS_COMMANDS);
+        char *uuid = zmsg_popstr (recv);
+        assert (streq (uuid, "uuid1237"));
+        zstr_free (&uuid);
+        char *stats = zmsg_popstr (recv);
+        assert (streq (stats, "STATS"));
+        zstr_free (&stats);
+        char *bounds = zmsg_popstr (recv);
+        assert (strstr (bounds, "+Inf"));
+        zstr_free (&bounds);
+
+        // INFO was answered above; buckets are cumulative, so the last
+        // (+Inf) one counts every reply
+        char *command = zmsg_popstr (recv);
+        assert (streq (command, "INFO"));
+        char *requests = zmsg_popstr (recv);
+        char *replies = zmsg_popstr (recv);
+        char *sum = zmsg_popstr (recv);
+        char *buckets = zmsg_popstr (recv);
+        assert (atoi (requests) > 0);
+        assert (streq (requests, replies));
+        const char *last = strrchr (buckets, ' ');
+        assert (last && streq (last + 1, replies));
+        zstr_free (&buckets);
+        zstr_free (&sum);
+        zstr_free (&replies);
+        zstr_free (&requests);
+        zstr_free (&command);
+        zmsg_destroy (&recv);
+        log_info ("OK\n");
+    }
+    {
+        // TEST #11: metrics pushed on stream as one message per cycle
+        log_info ("fty-info-test:Test #11: metrics on stream");
+        int rv = mlm_client_set_consumer (client, FTY_PROTO_STREAM_METRICS, METRICS_BATCH_CMD "@.*");
+        assert (rv >= 0);
+        zstr_sendx (info_server, "PRODUCER", FTY_PROTO_STREAM_METRICS, NULL);
+        zstr_sendx (info_server, "METRICSOUTPUT", "both", NULL);
+        zstr_sendx (info_server, "LINUXMETRICS", NULL);
+
+        zmsg_t *recv = mlm_client_recv (client);
+        assert (recv);
+        assert (streq (mlm_client_command (client), "STREAM DELIVER"));
+        char *val = zmsg_popstr (recv);
+        assert (streq (val, METRICS_BATCH_CMD));
+        zstr_free (&val);
+        char *asset = zmsg_popstr (recv);
+        assert (asset);
+        // the rest are fty_proto metrics
+        assert (zmsg_size (recv) > 0);
+        zframe_t *frame = zmsg_pop (recv);
+        while (frame) {
+            zmsg_t *metric_msg = zmsg_new ();
+            zmsg_append (metric_msg, &frame);
+            fty_proto_t *metric = fty_proto_decode (&metric_msg);
+            assert (metric);
+            assert (fty_proto_id (metric) == FTY_PROTO_METRIC);
+            assert (streq (fty_proto_name (metric), asset));
+            fty_proto_destroy (&metric);
+            frame = zmsg_pop (recv);
+        }
+        zstr_free (&asset);
+        zmsg_destroy (&recv);
+        zstr_sendx (info_server, "METRICSOUTPUT", "shm", NULL);
+        log_info ("OK\n");
+    }
 
     mlm_client_destroy (&asset_generator);
     //  @end
@@ -28,7 +28,6 @@
 
 #include "fty_info_classes.h"
 
-#include <cxxtools/jsondeserializer.h>
 #include <istream>
 #include <fstream>
 #include <set>
@@ -84,56 +83,29 @@ s_get_installation_date (
     }
 }
 
-static const char* RELEASE_DETAILS = "/etc/release-details.json";
-
-static cxxtools::SerializationInfo*
-s_load_release_details()
-{
-    cxxtools::SerializationInfo *si = new cxxtools::SerializationInfo();
-    try {
-        std::ifstream f(RELEASE_DETAILS);
-        std::string json_string (std::istreambuf_iterator<char>(f), {});
-        std::stringstream s(json_string);
-        cxxtools::JsonDeserializer json(s);
-        json.deserialize (*si);
-        log_info("fty-info:load %s OK",RELEASE_DETAILS);
-    }
-    catch (const std::exception& e) {
-        log_error ("Error while parsing JSON: %s", e.what ());
-    }
-    return si;
-}
-
 static char*
-s_get_release_details
-    (cxxtools::SerializationInfo *si,
-     const char *key,
-     const char * dfl)
+s_get_release_details (const char *value, const char * dfl)
 {
-    std::string value;
-    try {
-        si->getMember("release-details").getMember(key) >>= value;
-    }
-    catch (const std::exception& e) {
-        log_info ("Problem with getting %s in JSON: %s", key, e.what ());
-        if (dfl) {
-            return strdup(dfl);
-        } else {
-            return NULL;
-        }
-    }
-    if (value.empty () && dfl) {
-	    return strdup (dfl);
-    }
-    return strdup(value.c_str());
+    if (!value || (streq (value, "") && dfl))
+        return dfl ? strdup (dfl) : NULL;
+    return strdup (value);
 }
 
 //  --------------------------------------------------------------------------
 //  Create a new ftyinfo
 
 ftyinfo_t *
-ftyinfo_new (topologyresolver_t *resolver, const char *path)
+ftyinfo_new (topologyresolver_t *resolver, const char *path, releasedetails_t *details, localaddrs_t *addrs)
 {
+    releasedetails_t *own_details = NULL;
+    if (!details) {
+        own_details = details = releasedetails_new (NULL);
+        releasedetails_refresh (details);
+    }
+    localaddrs_t *own_addrs = NULL;
+    if (!addrs)
+        own_addrs = addrs = localaddrs_new (false);
+
     ftyinfo_t *self = (ftyinfo_t *) zmalloc (sizeof (ftyinfo_t));
     self->infos = zhash_new();
 
@@ -171,15 +143,13 @@ ftyinfo_new (topologyresolver_t *resolver, const char *path)
     log_info ("fty-info:parent_uri= '%s'", self->parent_uri);
 
     //set uuid, vendor, product, part_number, verson from /etc/release-details.json
-    cxxtools::SerializationInfo *si = nullptr;
-    si = s_load_release_details();
-    self->uuid   = s_get_release_details (si, "uuid", NULL);
-    self->vendor = s_get_release_details (si, "hardware-vendor", NULL);
+    self->uuid   = s_get_release_details (releasedetails_uuid (details), NULL);
+    self->vendor = s_get_release_details (releasedetails_vendor (details), NULL);
     self->manufacturer = self->vendor;
-    self->serial = s_get_release_details (si, "hardware-serial-number", "N/A");
-    self->product  = s_get_release_details (si, "hardware-catalog-number", NULL);
-    self->part_number  = s_get_release_details (si, "hardware-part-number", NULL);
-    self->version   = s_get_release_details (si, "osimage-name", NULL);
+    self->serial = s_get_release_details (releasedetails_serial (details), "N/A");
+    self->product  = s_get_release_details (releasedetails_catalog_number (details), NULL);
+    self->part_number  = s_get_release_details (releasedetails_part_number (details), NULL);
+    self->version   = s_get_release_details (releasedetails_osimage_name (details), NULL);
     log_info ("fty-info:uuid         = '%s'", self->uuid);
     log_info ("fty-info:vendor       = '%s'", self->vendor);
     log_info ("fty-info:manufacturer = '%s'", self->manufacturer);
@@ -212,33 +182,14 @@ ftyinfo_new (topologyresolver_t *resolver, const char *path)
     log_info ("fty-info:type = '%s'", self->type);
     log_info ("fty-info:txtvers = '%s'", self->txtvers);
 
-    // search for IPv4 addresses
-    int counter = 0;
-    for (counter = 0; counter < 3; ++counter) {
-        self->ip[counter] = NULL;
-    }
-    counter = 0;
-    struct ifaddrs *interfaces, *iface;
-    char host[NI_MAXHOST];
-    if (getifaddrs (&interfaces) != -1) {
-        for (iface = interfaces; iface != NULL; iface = iface->ifa_next) {
-            if (iface->ifa_addr == NULL) continue;
-            // here we support IPv4 only, only get first 3 addresses
-            if (iface->ifa_addr->sa_family == AF_INET &&
-                    0 == getnameinfo(iface->ifa_addr,sizeof(struct sockaddr_in),
-                            host, NI_MAXHOST, NULL, 0, NI_NUMERICHOST)) {
-                self->ip[counter] = strdup(host);
-                ++counter;
-            }
-            if (counter == 3) {
-                break;
-            }
-        }
-        freeifaddrs(interfaces);
+    // here we support IPv4 only, only get first 3 addresses
+    for (int counter = 0; counter < 3; ++counter) {
+        const char *ip = localaddrs_ipv4 (addrs, counter);
+        self->ip[counter] = ip ? strdup (ip) : NULL;
     }
 
-    if(si)
-        delete si;
+    releasedetails_destroy (&own_details);
+    localaddrs_destroy (&own_addrs);
 
     return self;
 }
@@ -314,6 +265,16 @@ ftyinfo_destroy (ftyinfo_t **self_ptr)
     }
 }
 
+//  --------------------------------------------------------------------------
+//  Return path of accepted license file, from which installDate is taken.
+//  The caller owns the string.
+
+char *
+ftyinfo_license_file (void)
+{
+    return s_get_accepted_license_file ();
+}
+
 //  --------------------------------------------------------------------------
 //  getters
 
@@ -355,3 +316,56 @@ zhash_t *ftyinfo_infohash (ftyinfo_t *self)
 
     return self->infos;
 }
+
+//  --------------------------------------------------------------------------
+//  Offsets of fields by infohash key, sorted by key
+typedef struct {
+    const char *key;
+    size_t offset;
+} ftyinfo_field_t;
+
+static const ftyinfo_field_t s_fields [] = {
+    { INFO_CONTACT,         offsetof (ftyinfo_t, contact) },
+    { INFO_DESCRIPTION,     offsetof (ftyinfo_t, description) },
+    { INFO_HOSTNAME,        offsetof (ftyinfo_t, hostname) },
+    { INFO_ID,              offsetof (ftyinfo_t, id) },
+    { INFO_INSTALL_DATE,    offsetof (ftyinfo_t, installDate) },
+    { INFO_IP1,             offsetof (ftyinfo_t, ip) },
+    { INFO_IP2,             offsetof (ftyinfo_t, ip) + sizeof (char *) },
+    { INFO_IP3,             offsetof (ftyinfo_t, ip) + 2 * sizeof (char *) },
+    { INFO_LOCATION,        offsetof (ftyinfo_t, location) },
+    { INFO_MANUFACTURER,    offsetof (ftyinfo_t, manufacturer) },
+    { INFO_NAME,            offsetof (ftyinfo_t, name) },
+    { INFO_NAME_URI,        offsetof (ftyinfo_t, name_uri) },
+    { INFO_PARENT_URI,      offsetof (ftyinfo_t, parent_uri) },
+    { INFO_PART_NUMBER,     offsetof (ftyinfo_t, part_number) },
+    { INFO_REST_PATH,       offsetof (ftyinfo_t, path) },
+    { INFO_PRODUCT,         offsetof (ftyinfo_t, product) },
+    { INFO_PROTOCOL_FORMAT, offsetof (ftyinfo_t, protocol_format) },
+    { INFO_SERIAL,          offsetof (ftyinfo_t, serial) },
+    { INFO_TXTVERS,         offsetof (ftyinfo_t, txtvers) },
+    { INFO_TYPE,            offsetof (ftyinfo_t, type) },
+    { INFO_UUID,            offsetof (ftyinfo_t, uuid) },
+    { INFO_VENDOR,          offsetof (ftyinfo_t, vendor) },
+    { INFO_VERSION,         offsetof (ftyinfo_t, version) }
+};
+
+//  --------------------------------------------------------------------------
+//  Return value of one infohash key without building the hash
+
+static int
+s_field_compare (const void *key, const void *field)
+{
+    return strcmp ((const char *) key, ((const ftyinfo_field_t *) field)->key);
+}
+
+const char *
+ftyinfo_field (ftyinfo_t *self, const char *key)
+{
+    if (!self || !key) return NULL;
+    const ftyinfo_field_t *field = (const ftyinfo_field_t *) bsearch (
+        key, s_fields, sizeof (s_fields) / sizeof (s_fields [0]), sizeof (s_fields [0]), s_field_compare);
+    if (!field)
+        return NULL;
+    return *(const char **) ((const char *) self + field->offset);
+}
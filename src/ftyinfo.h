@@ -94,9 +94,11 @@ struct _ftyinfo_t {
 };
 
 //  @interface
-//  Create a new ftyinfo
+//  Create a new ftyinfo, release details are taken from details as they are
+//  (caller refreshes them); NULL means to read the default file. IP addresses
+//  are taken from addrs, NULL means to read them now.
 FTY_INFO_PRIVATE ftyinfo_t *
-    ftyinfo_new (topologyresolver_t *resolver, const char * path);
+    ftyinfo_new (topologyresolver_t *resolver, const char * path, releasedetails_t *details, localaddrs_t *addrs);
 
 FTY_INFO_PRIVATE ftyinfo_t *
     ftyinfo_test_new (void);
@@ -105,6 +107,10 @@ FTY_INFO_PRIVATE ftyinfo_t *
 FTY_INFO_PRIVATE void
     ftyinfo_destroy (ftyinfo_t **self_p);
 
+//  Return path of accepted license file, caller owns the string
+FTY_INFO_PRIVATE char *
+    ftyinfo_license_file (void);
+
 // getters
 FTY_INFO_PRIVATE const char *
     ftyinfo_uuid (ftyinfo_t *self);
@@ -112,6 +118,11 @@ FTY_INFO_PRIVATE const char *
 FTY_INFO_PRIVATE zhash_t *
     ftyinfo_infohash (ftyinfo_t *self);
 
+//  Return value of one infohash key without building the hash, NULL if the
+//  key is unknown or has no value
+FTY_INFO_PRIVATE const char *
+    ftyinfo_field (ftyinfo_t *self, const char *key);
+
 //  @end
 
 #ifdef __cplusplus
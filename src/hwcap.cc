@@ -0,0 +1,344 @@
+/*  =========================================================================
+    hwcap - Cache of parsed hardware capabilities with pre-rendered replies
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    hwcap - Cache of parsed hardware capabilities with pre-rendered replies
+@discuss
+    Capability file (HW_CAP_FILE) is parsed once into typed values and
+    replies to HW_CAP requests of all supported types are rendered right
+    away, so a request costs a lookup and a copy of frames. Owner loads the
+    file again when it changes.
+@end
+*/
+
+#include <string>
+#include <vector>
+
+#include "fty_info_classes.h"
+
+//  GPI or GPO description
+typedef struct {
+    bool present;
+    int count;
+    int base_address;
+    int offset;
+    std::vector<std::pair<std::string, int>> mapping;  //  io number, pin
+} hwcap_io_t;
+
+typedef enum {
+    IO_GPI = 0,
+    IO_GPO,
+    IO_COUNT
+} hwcap_io_index_t;
+
+static const char *s_io_names [IO_COUNT] = { "gpi", "gpo" };
+
+//  Structure of our class
+
+struct _hwcap_t {
+    bool loaded;
+    std::string type;
+    hwcap_io_t io [IO_COUNT];
+    zmsg_t *io_reply [IO_COUNT];
+    zmsg_t *type_reply;
+    zmsg_t *unsupported_reply;
+};
+
+
+//  --------------------------------------------------------------------------
+//  Drop loaded capabilities
+
+static void
+s_clear (hwcap_t *self)
+{
+    self->loaded = false;
+    self->type.clear ();
+    for (int i = 0; i < IO_COUNT; i++) {
+        self->io [i].present = false;
+        self->io [i].count = -1;
+        self->io [i].base_address = -1;
+        self->io [i].offset = 0;
+        self->io [i].mapping.clear ();
+        zmsg_destroy (&self->io_reply [i]);
+    }
+    zmsg_destroy (&self->type_reply);
+}
+
+
+//  --------------------------------------------------------------------------
+//  Create a new hwcap
+
+hwcap_t *
+hwcap_new (void)
+{
+    hwcap_t *self = new hwcap_t;
+    assert (self);
+    for (int i = 0; i < IO_COUNT; i++)
+        self->io_reply [i] = NULL;
+    self->type_reply = NULL;
+    s_clear (self);
+    self->unsupported_reply = zmsg_new ();
+    zmsg_addstr (self->unsupported_reply, "ERROR");
+    zmsg_addstr (self->unsupported_reply, "unsupported type");
+    return self;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Destroy the hwcap
+
+void
+hwcap_destroy (hwcap_t **self_p)
+{
+    assert (self_p);
+    if (*self_p) {
+        hwcap_t *self = *self_p;
+        s_clear (self);
+        zmsg_destroy (&self->unsupported_reply);
+        delete self;
+        *self_p = NULL;
+    }
+}
+
+
+//  --------------------------------------------------------------------------
+//  Return value of key, empty value counts as missing
+
+static const char *
+s_get (zconfig_t *config, const char *key)
+{
+    char *value = zconfig_get (config, key, NULL);
+    return value && !streq (value, "") ? value : NULL;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Parse one io section and render its reply. Reply keeps values as they
+//  are written in the file.
+
+static void
+s_load_io (hwcap_t *self, zconfig_t *cap, int index)
+{
+    const char *name = s_io_names [index];
+    hwcap_io_t *io = &self->io [index];
+    zconfig_t *section = zconfig_locate (cap, std::string ("hardware/").append (name).c_str ());
+    io->present = section != NULL;
+
+    const char *count = section ? s_get (section, "count") : NULL;
+    const char *base_address = section ? s_get (section, "base_address") : NULL;
+    const char *offset = section ? s_get (section, "offset") : NULL;
+    io->count = count ? (int) strtol (count, NULL, 0) : -1;
+    io->base_address = base_address ? (int) strtol (base_address, NULL, 0) : -1;
+    io->offset = offset ? (int) strtol (offset, NULL, 0) : 0;
+
+    zmsg_t *reply = zmsg_new ();
+    zmsg_addstr (reply, "OK");
+    zmsg_addstr (reply, name);
+    zmsg_addstr (reply, count ? count : "");
+    if (!count || !streq (count, "0")) {
+        zmsg_addstr (reply, base_address ? base_address : "");
+        zmsg_addstr (reply, offset ? offset : "");
+        zconfig_t *mapping = section ? zconfig_locate (section, "mapping") : NULL;
+        for (zconfig_t *item = mapping ? zconfig_child (mapping) : NULL; item; item = zconfig_next (item)) {
+            const char *value = zconfig_value (item) ? zconfig_value (item) : "";
+            io->mapping.push_back (std::make_pair (std::string (zconfig_name (item)), (int) strtol (value, NULL, 0)));
+            zmsg_addstr (reply, zconfig_name (item));
+            zmsg_addstr (reply, value);
+        }
+    }
+    self->io_reply [index] = reply;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Parse capability file and render replies
+
+int
+hwcap_load (hwcap_t *self, const char *path)
+{
+    assert (self);
+    assert (path);
+    s_clear (self);
+    zconfig_t *cap = zconfig_load (path);
+    if (!cap) {
+        log_debug ("hwcap: cannot load capability file %s", path);
+        return -1;
+    }
+
+    const char *type = s_get (cap, "hardware/type");
+    self->type.assign (type ? type : "");
+    self->type_reply = zmsg_new ();
+    zmsg_addstr (self->type_reply, "OK");
+    zmsg_addstr (self->type_reply, "type");
+    zmsg_addstr (self->type_reply, self->type.c_str ());
+
+    for (int i = 0; i < IO_COUNT; i++)
+        s_load_io (self, cap, i);
+
+    zconfig_destroy (&cap);
+    self->loaded = true;
+    log_info ("hwcap: loaded %s", path);
+    return 0;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Typed getters
+
+static hwcap_io_t *
+s_io (hwcap_t *self, const char *io)
+{
+    assert (self);
+    for (int i = 0; io && i < IO_COUNT; i++) {
+        if (streq (io, s_io_names [i]) && self->io [i].present)
+            return &self->io [i];
+    }
+    return NULL;
+}
+
+const char *
+hwcap_type (hwcap_t *self)
+{
+    assert (self);
+    return self->loaded && !self->type.empty () ? self->type.c_str () : NULL;
+}
+
+int
+hwcap_count (hwcap_t *self, const char *io)
+{
+    hwcap_io_t *entry = s_io (self, io);
+    return entry ? entry->count : -1;
+}
+
+int
+hwcap_base_address (hwcap_t *self, const char *io)
+{
+    hwcap_io_t *entry = s_io (self, io);
+    return entry ? entry->base_address : -1;
+}
+
+int
+hwcap_offset (hwcap_t *self, const char *io)
+{
+    hwcap_io_t *entry = s_io (self, io);
+    return entry ? entry->offset : 0;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Return copy of reply to HW_CAP request for type
+
+zmsg_t *
+hwcap_reply (hwcap_t *self, const char *type)
+{
+    assert (self);
+    if (!self->loaded || !type)
+        return NULL;
+    for (int i = 0; i < IO_COUNT; i++) {
+        if (streq (type, s_io_names [i]))
+            return zmsg_dup (self->io_reply [i]);
+    }
+    if (streq (type, "type"))
+        return zmsg_dup (self->type_reply);
+    if (streq (type, "serial"))
+        // not implemented yet
+        return NULL;
+    log_info ("hwcap: unsuported request for '%s'", type);
+    return zmsg_dup (self->unsupported_reply);
+}
+
+
+//  --------------------------------------------------------------------------
+//  Self test of this class
+
+void
+hwcap_test (bool verbose)
+{
+    printf (" * hwcap: ");
+
+    //  @selftest
+    const char *SELFTEST_DIR_RO = "src/selftest-ro";
+    assert (SELFTEST_DIR_RO);
+    char *path = zsys_sprintf ("%s/data/hw_cap/%s", SELFTEST_DIR_RO, HW_CAP_FILE);
+
+    hwcap_t *self = hwcap_new ();
+    assert (self);
+    assert (hwcap_reply (self, "type") == NULL);
+
+    assert (hwcap_load (self, path) == 0);
+    assert (streq (hwcap_type (self), "ipc"));
+    assert (hwcap_count (self, "gpi") == 10);
+    assert (hwcap_base_address (self, "gpi") == 488);
+    assert (hwcap_offset (self, "gpi") == -1);
+    assert (hwcap_count (self, "gpo") == 5);
+    assert (hwcap_offset (self, "gpo") == 20);
+    assert (hwcap_count (self, "serial") == -1);
+
+    zmsg_t *reply = hwcap_reply (self, "gpo");
+    assert (reply);
+    assert (zmsg_size (reply) == 9);
+    const char *expected [] = { "OK", "gpo", "5", "488", "20", "p4", "502", "p5", "503" };
+    for (size_t i = 0; i < sizeof (expected) / sizeof (expected [0]); i++) {
+        char *frame = zmsg_popstr (reply);
+        assert (frame && streq (frame, expected [i]));
+        zstr_free (&frame);
+    }
+    zmsg_destroy (&reply);
+
+    // cached reply is not consumed
+    reply = hwcap_reply (self, "gpo");
+    assert (zmsg_size (reply) == 9);
+    zmsg_destroy (&reply);
+
+    reply = hwcap_reply (self, "gpi");
+    assert (zmsg_size (reply) == 5);
+    zmsg_destroy (&reply);
+
+    reply = hwcap_reply (self, "type");
+    assert (zmsg_size (reply) == 3);
+    char *frame = zmsg_popstr (reply);
+    zstr_free (&frame);
+    frame = zmsg_popstr (reply);
+    zstr_free (&frame);
+    frame = zmsg_popstr (reply);
+    assert (frame && streq (frame, "ipc"));
+    zstr_free (&frame);
+    zmsg_destroy (&reply);
+
+    reply = hwcap_reply (self, "foo");
+    frame = zmsg_popstr (reply);
+    assert (frame && streq (frame, "ERROR"));
+    zstr_free (&frame);
+    zmsg_destroy (&reply);
+    assert (hwcap_reply (self, "serial") == NULL);
+
+    // missing file empties the cache
+    assert (hwcap_load (self, "/nonexistent/" HW_CAP_FILE) == -1);
+    assert (hwcap_type (self) == NULL);
+    assert (hwcap_reply (self, "gpo") == NULL);
+
+    hwcap_destroy (&self);
+    assert (self == NULL);
+    zstr_free (&path);
+    //  @end
+    printf ("OK\n");
+}
@@ -0,0 +1,78 @@
+/*  =========================================================================
+    hwcap - Cache of parsed hardware capabilities with pre-rendered replies
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#ifndef HWCAP_H_INCLUDED
+#define HWCAP_H_INCLUDED
+
+#define HW_CAP_FILE "42ity-capabilities.dsc"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  @interface
+//  Create a new empty hwcap
+FTY_INFO_PRIVATE hwcap_t *
+    hwcap_new (void);
+
+//  Destroy the hwcap
+FTY_INFO_PRIVATE void
+    hwcap_destroy (hwcap_t **self_p);
+
+//  Parse capability file and render replies. If the file can't be loaded,
+//  cache becomes empty.
+//  Return 0 on success, -1 on error
+FTY_INFO_PRIVATE int
+    hwcap_load (hwcap_t *self, const char *path);
+
+//  Return hardware type, NULL if unknown
+FTY_INFO_PRIVATE const char *
+    hwcap_type (hwcap_t *self);
+
+//  Return number of pins of io ("gpi" or "gpo"), -1 if unknown
+FTY_INFO_PRIVATE int
+    hwcap_count (hwcap_t *self, const char *io);
+
+//  Return base address of io chipset, -1 if unknown
+FTY_INFO_PRIVATE int
+    hwcap_base_address (hwcap_t *self, const char *io);
+
+//  Return offset of io pins, 0 if unknown
+FTY_INFO_PRIVATE int
+    hwcap_offset (hwcap_t *self, const char *io);
+
+//  Return copy of reply to HW_CAP request for type, without correlation id:
+//  OK/type/... or ERROR/unsupported type. Return NULL if there is no
+//  information about the type (file not loaded, or type not implemented).
+FTY_INFO_PRIVATE zmsg_t *
+    hwcap_reply (hwcap_t *self, const char *type);
+
+//  Self test of this class
+FTY_INFO_PRIVATE void
+    hwcap_test (bool verbose);
+
+//  @end
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
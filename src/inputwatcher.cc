@@ -0,0 +1,249 @@
+/*  =========================================================================
+    inputwatcher - Watcher of files from which agent data is derived
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    inputwatcher - Watcher of files from which agent data is derived
+@discuss
+    One inotify instance watches parent directories of all registered
+    files; files are usually replaced by rename, which a watch of the file
+    itself would not survive. The owner polls the descriptor and turns the
+    returned bitmask into invalidation of its caches, so nothing derived
+    from these files needs to be checked per request.
+
+    Hostname is watched through HOSTNAME_FILE, which hostnamectl rewrites.
+@end
+*/
+
+#include <string>
+#include <vector>
+#include <sys/inotify.h>
+
+#include "fty_info_classes.h"
+
+#define INPUTWATCHER_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE)
+
+//  One watched file
+typedef struct {
+    input_t input;
+    int wd;                 //  watch of parent directory, -1 if none
+    std::string dir;
+    std::string name;
+} input_entry_t;
+
+//  Structure of our class
+
+struct _inputwatcher_t {
+    int fd;
+    std::vector<input_entry_t> entries;
+};
+
+
+//  --------------------------------------------------------------------------
+//  Create a new inputwatcher
+
+inputwatcher_t *
+inputwatcher_new (void)
+{
+    inputwatcher_t *self = new inputwatcher_t;
+    assert (self);
+    self->fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+    if (self->fd == -1)
+        log_error ("inputwatcher: cannot initialize inotify: %s", strerror (errno));
+    return self;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Destroy the inputwatcher
+
+void
+inputwatcher_destroy (inputwatcher_t **self_p)
+{
+    assert (self_p);
+    if (*self_p) {
+        inputwatcher_t *self = *self_p;
+        if (self->fd != -1)
+            close (self->fd);
+        delete self;
+        *self_p = NULL;
+    }
+}
+
+
+//  --------------------------------------------------------------------------
+//  Watch file path as input
+
+int
+inputwatcher_add (inputwatcher_t *self, input_t input, const char *path)
+{
+    assert (self);
+    assert (path);
+    input_entry_t entry;
+    entry.input = input;
+    const char *slash = strrchr (path, '/');
+    entry.dir = slash ? (slash == path ? "/" : std::string (path, slash - path)) : ".";
+    entry.name = slash ? slash + 1 : path;
+    entry.wd = -1;
+
+    // drop previous path of input, and its watch if nobody else needs it
+    for (auto it = self->entries.begin (); it != self->entries.end (); ++it) {
+        if (it->input != input)
+            continue;
+        int wd = it->wd;
+        self->entries.erase (it);
+        bool used = false;
+        for (const auto &other : self->entries)
+            used = used || other.wd == wd;
+        if (wd != -1 && !used && self->fd != -1)
+            inotify_rm_watch (self->fd, wd);
+        break;
+    }
+
+    // watch of the same directory is shared, kernel returns the same wd
+    if (self->fd != -1)
+        entry.wd = inotify_add_watch (self->fd, entry.dir.c_str (), INPUTWATCHER_MASK);
+    self->entries.push_back (entry);
+    if (entry.wd == -1) {
+        log_warning ("inputwatcher: cannot watch %s: %s", entry.dir.c_str (), strerror (errno));
+        return -1;
+    }
+    log_debug ("inputwatcher: watching %s", path);
+    return 0;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Return file descriptor which becomes readable when some input changes
+
+int
+inputwatcher_fd (inputwatcher_t *self)
+{
+    assert (self);
+    return self->fd;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Read all pending notifications
+
+int
+inputwatcher_read (inputwatcher_t *self)
+{
+    assert (self);
+    if (self->fd == -1)
+        return 0;
+
+    int changed = 0;
+    char buffer [4096] __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+    while (true) {
+        ssize_t size = read (self->fd, buffer, sizeof (buffer));
+        if (size == -1 && errno == EINTR)
+            continue;
+        if (size <= 0)
+            break;
+        for (char *ptr = buffer; ptr < buffer + size; ) {
+            const struct inotify_event *event = (const struct inotify_event *) ptr;
+            ptr += sizeof (struct inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                log_warning ("inputwatcher: event queue overflow, considering all inputs changed");
+                changed |= INPUT_ALL;
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                // watched directory disappeared
+                for (auto &entry : self->entries) {
+                    if (entry.wd == event->wd) {
+                        log_warning ("inputwatcher: %s is not watched any more", entry.dir.c_str ());
+                        entry.wd = -1;
+                        changed |= entry.input;
+                    }
+                }
+                continue;
+            }
+            if (!event->len)
+                continue;
+            for (const auto &entry : self->entries) {
+                if (entry.wd == event->wd && entry.name == event->name)
+                    changed |= entry.input;
+            }
+        }
+    }
+    return changed;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Self test of this class
+
+void
+inputwatcher_test (bool verbose)
+{
+    printf (" * inputwatcher: ");
+
+    //  @selftest
+    const char *SELFTEST_DIR_RW = "src/selftest-rw";
+    assert (SELFTEST_DIR_RW);
+    zsys_dir_create (SELFTEST_DIR_RW);
+    char *details = zsys_sprintf ("%s/release-details.json", SELFTEST_DIR_RW);
+    char *license = zsys_sprintf ("%s/license", SELFTEST_DIR_RW);
+    char *tmp = zsys_sprintf ("%s/license.tmp", SELFTEST_DIR_RW);
+
+    inputwatcher_t *self = inputwatcher_new ();
+    assert (self);
+    assert (inputwatcher_add (self, INPUT_RELEASE_DETAILS, details) == 0);
+    assert (inputwatcher_add (self, INPUT_LICENSE, license) == 0);
+    assert (inputwatcher_add (self, INPUT_HOSTNAME, "/nonexistent/hostname") == -1);
+    assert (inputwatcher_read (self) == 0);
+
+    // write of a watched file
+    FILE *f = fopen (details, "w");
+    assert (f);
+    fprintf (f, "{}\n");
+    fclose (f);
+    zmq_pollitem_t item = { NULL, inputwatcher_fd (self), ZMQ_POLLIN, 0 };
+    assert (zmq_poll (&item, 1, 1000) == 1);
+    assert (inputwatcher_read (self) == INPUT_RELEASE_DETAILS);
+
+    // replacement by rename, unrelated file in the same directory is ignored
+    f = fopen (tmp, "w");
+    assert (f);
+    fprintf (f, "1\n1500000000\n");
+    fclose (f);
+    assert (rename (tmp, license) == 0);
+    assert (zmq_poll (&item, 1, 1000) == 1);
+    assert (inputwatcher_read (self) == INPUT_LICENSE);
+
+    // input moved to another file
+    assert (inputwatcher_add (self, INPUT_LICENSE, tmp) == 0);
+    unlink (license);
+    unlink (details);
+    assert (zmq_poll (&item, 1, 1000) == 1);
+    assert (inputwatcher_read (self) == INPUT_RELEASE_DETAILS);
+
+    inputwatcher_destroy (&self);
+    assert (self == NULL);
+    zstr_free (&tmp);
+    zstr_free (&license);
+    zstr_free (&details);
+    //  @end
+    printf ("OK\n");
+}
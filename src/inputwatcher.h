@@ -0,0 +1,77 @@
+/*  =========================================================================
+    inputwatcher - Watcher of files from which agent data is derived
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#ifndef INPUTWATCHER_H_INCLUDED
+#define INPUTWATCHER_H_INCLUDED
+
+//  File with hostname, written by hostnamectl
+#define HOSTNAME_FILE "/etc/hostname"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  Watched inputs, inputwatcher_read returns bitmask of them
+typedef enum {
+    INPUT_RELEASE_DETAILS = 1 << 0,
+    INPUT_LICENSE         = 1 << 1,
+    INPUT_HW_CAP          = 1 << 2,
+    INPUT_HOSTNAME        = 1 << 3,
+    INPUT_CONFIG          = 1 << 4,
+    INPUT_ALL             = (1 << 5) - 1
+} input_t;
+
+//  @interface
+//  Create a new inputwatcher
+FTY_INFO_PRIVATE inputwatcher_t *
+    inputwatcher_new (void);
+
+//  Destroy the inputwatcher
+FTY_INFO_PRIVATE void
+    inputwatcher_destroy (inputwatcher_t **self_p);
+
+//  Watch file path as input, path replaces previous one of the same input.
+//  Parent directory is watched, so creation or replacement of the file by
+//  rename is noticed too.
+//  Return 0 on success, -1 if the directory can't be watched
+FTY_INFO_PRIVATE int
+    inputwatcher_add (inputwatcher_t *self, input_t input, const char *path);
+
+//  Return file descriptor which becomes readable when some input changes
+FTY_INFO_PRIVATE int
+    inputwatcher_fd (inputwatcher_t *self);
+
+//  Read all pending notifications
+//  Return bitmask of changed inputs, 0 if none
+FTY_INFO_PRIVATE int
+    inputwatcher_read (inputwatcher_t *self);
+
+//  Self test of this class
+FTY_INFO_PRIVATE void
+    inputwatcher_test (bool verbose);
+
+//  @end
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,433 @@
+/*  =========================================================================
+    localaddrs - Registry of local IP addresses maintained from netlink
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    localaddrs - Registry of local IP addresses maintained from netlink
+@discuss
+    Addresses are dumped once by RTM_GETADDR and then kept up to date from
+    RTNLGRP_IPV4_IFADDR and RTNLGRP_IPV6_IFADDR notifications. They are
+    stored in binary form in an array sorted by address, so membership test
+    is a binary search without any allocation. Textual form is rendered once
+    when the address appears.
+
+    When the notification queue overflows, addresses are dumped again.
+@end
+*/
+
+#include <vector>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include "fty_info_classes.h"
+
+//  One local address
+typedef struct {
+    unsigned char family;
+    unsigned char addr [16];    //  IPv4 address is padded by zeros
+    int ifindex;
+    uint64_t seq;               //  order in which addresses appeared
+    char text [INET6_ADDRSTRLEN];
+} localaddr_t;
+
+//  Structure of our class
+
+struct _localaddrs_t {
+    int fd;                         //  subscribed netlink socket, -1 if none
+    uint64_t seq;
+    std::vector<localaddr_t> addrs; //  sorted by family and address
+    std::vector<size_t> ipv4;       //  indexes of IPv4 addresses in interface order
+};
+
+
+//  --------------------------------------------------------------------------
+//  Order of addresses in the array
+
+static int
+s_compare (unsigned char family, const unsigned char *addr, const localaddr_t &entry)
+{
+    if (family != entry.family)
+        return family < entry.family ? -1 : 1;
+    return memcmp (addr, entry.addr, sizeof (entry.addr));
+}
+
+static bool
+s_less (const localaddr_t &a, const localaddr_t &b)
+{
+    return s_compare (a.family, a.addr, b) < 0;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Rebuild list of IPv4 addresses in interface order
+
+static void
+s_index (localaddrs_t *self)
+{
+    self->ipv4.clear ();
+    for (size_t i = 0; i < self->addrs.size (); i++) {
+        if (self->addrs [i].family == AF_INET)
+            self->ipv4.push_back (i);
+    }
+    const std::vector<localaddr_t> &addrs = self->addrs;
+    std::sort (self->ipv4.begin (), self->ipv4.end (), [&addrs] (size_t a, size_t b) {
+        if (addrs [a].ifindex != addrs [b].ifindex)
+            return addrs [a].ifindex < addrs [b].ifindex;
+        return addrs [a].seq < addrs [b].seq;
+    });
+}
+
+
+//  --------------------------------------------------------------------------
+//  Apply one RTM_NEWADDR or RTM_DELADDR message
+//  Return true if the set changed
+
+static bool
+s_apply (localaddrs_t *self, struct nlmsghdr *header)
+{
+    if (header->nlmsg_type != RTM_NEWADDR && header->nlmsg_type != RTM_DELADDR)
+        return false;
+    struct ifaddrmsg *ifa = (struct ifaddrmsg *) NLMSG_DATA (header);
+    if (ifa->ifa_family != AF_INET && ifa->ifa_family != AF_INET6)
+        return false;
+
+    // IFA_LOCAL is the local end of point-to-point link, IFA_ADDRESS the peer
+    const void *address = NULL;
+    const void *local = NULL;
+    int length = IFA_PAYLOAD (header);
+    for (struct rtattr *attr = IFA_RTA (ifa); RTA_OK (attr, length); attr = RTA_NEXT (attr, length)) {
+        if (attr->rta_type == IFA_ADDRESS)
+            address = RTA_DATA (attr);
+        else
+        if (attr->rta_type == IFA_LOCAL)
+            local = RTA_DATA (attr);
+    }
+    if (local)
+        address = local;
+    if (!address)
+        return false;
+
+    localaddr_t entry;
+    memset (&entry, 0, sizeof (entry));
+    entry.family = ifa->ifa_family;
+    entry.ifindex = (int) ifa->ifa_index;
+    memcpy (entry.addr, address, ifa->ifa_family == AF_INET ? 4 : 16);
+
+    auto it = std::lower_bound (self->addrs.begin (), self->addrs.end (), entry, s_less);
+    while (it != self->addrs.end ()
+    &&     s_compare (entry.family, entry.addr, *it) == 0
+    &&     it->ifindex != entry.ifindex)
+        ++it;
+    bool found = it != self->addrs.end ()
+              && s_compare (entry.family, entry.addr, *it) == 0;
+
+    if (header->nlmsg_type == RTM_DELADDR) {
+        if (!found)
+            return false;
+        self->addrs.erase (it);
+        return true;
+    }
+    if (found)
+        return false;
+    entry.seq = self->seq++;
+    inet_ntop (entry.family, entry.addr, entry.text, sizeof (entry.text));
+    self->addrs.insert (it, entry);
+    return true;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Apply all netlink messages in buffer
+//  Return true if the set changed, done is set when dump finished
+
+static bool
+s_apply_buffer (localaddrs_t *self, char *buffer, ssize_t size, bool *done)
+{
+    bool changed = false;
+    int length = (int) size;
+    for (struct nlmsghdr *header = (struct nlmsghdr *) buffer;
+         NLMSG_OK (header, length);
+         header = NLMSG_NEXT (header, length)) {
+        if (header->nlmsg_type == NLMSG_DONE || header->nlmsg_type == NLMSG_ERROR) {
+            if (done)
+                *done = true;
+            break;
+        }
+        changed = s_apply (self, header) || changed;
+    }
+    return changed;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Replace addresses by a fresh dump, made on a socket of its own so it
+//  does not mix with notifications
+//  Return true if the set changed
+
+static bool
+s_dump (localaddrs_t *self)
+{
+    std::vector<localaddr_t> previous;
+    previous.swap (self->addrs);
+
+    int fd = socket (AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd == -1) {
+        log_error ("localaddrs: cannot open netlink socket: %s", strerror (errno));
+        s_index (self);
+        return !previous.empty ();
+    }
+    struct timeval timeout = { 1, 0 };
+    setsockopt (fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
+
+    struct {
+        struct nlmsghdr header;
+        struct ifaddrmsg ifa;
+    } request;
+    memset (&request, 0, sizeof (request));
+    request.header.nlmsg_len = NLMSG_LENGTH (sizeof (struct ifaddrmsg));
+    request.header.nlmsg_type = RTM_GETADDR;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.header.nlmsg_seq = 1;
+    request.ifa.ifa_family = AF_UNSPEC;
+
+    if (send (fd, &request, request.header.nlmsg_len, 0) == -1)
+        log_error ("localaddrs: cannot request addresses: %s", strerror (errno));
+    else {
+        char buffer [16384] __attribute__ ((aligned (__alignof__ (struct nlmsghdr))));
+        bool done = false;
+        while (!done) {
+            ssize_t size = recv (fd, buffer, sizeof (buffer), 0);
+            if (size == -1 && errno == EINTR)
+                continue;
+            if (size <= 0) {
+                log_error ("localaddrs: cannot read addresses: %s", strerror (errno));
+                break;
+            }
+            s_apply_buffer (self, buffer, size, &done);
+        }
+    }
+    close (fd);
+    s_index (self);
+
+    if (previous.size () != self->addrs.size ())
+        return true;
+    for (size_t i = 0; i < previous.size (); i++) {
+        if (s_compare (previous [i].family, previous [i].addr, self->addrs [i]) != 0
+        ||  previous [i].ifindex != self->addrs [i].ifindex)
+            return true;
+    }
+    return false;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Create a new localaddrs
+
+localaddrs_t *
+localaddrs_new (bool subscribe)
+{
+    localaddrs_t *self = new localaddrs_t;
+    assert (self);
+    self->fd = -1;
+    self->seq = 0;
+
+    // subscribe before the dump, so no change can be missed in between
+    if (subscribe) {
+        self->fd = socket (AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+        if (self->fd == -1)
+            log_error ("localaddrs: cannot open netlink socket: %s", strerror (errno));
+        else {
+            struct sockaddr_nl address;
+            memset (&address, 0, sizeof (address));
+            address.nl_family = AF_NETLINK;
+            address.nl_groups = RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+            if (bind (self->fd, (struct sockaddr *) &address, sizeof (address)) == -1) {
+                log_error ("localaddrs: cannot subscribe to address changes: %s", strerror (errno));
+                close (self->fd);
+                self->fd = -1;
+            }
+        }
+    }
+    s_dump (self);
+    return self;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Destroy the localaddrs
+
+void
+localaddrs_destroy (localaddrs_t **self_p)
+{
+    assert (self_p);
+    if (*self_p) {
+        localaddrs_t *self = *self_p;
+        if (self->fd != -1)
+            close (self->fd);
+        delete self;
+        *self_p = NULL;
+    }
+}
+
+
+//  --------------------------------------------------------------------------
+//  Return file descriptor readable when addresses change
+
+int
+localaddrs_fd (localaddrs_t *self)
+{
+    assert (self);
+    return self->fd;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Apply all pending address notifications
+
+bool
+localaddrs_update (localaddrs_t *self)
+{
+    assert (self);
+    if (self->fd == -1)
+        return false;
+
+    bool changed = false;
+    bool overflow = false;
+    char buffer [16384] __attribute__ ((aligned (__alignof__ (struct nlmsghdr))));
+    while (true) {
+        ssize_t size = recv (self->fd, buffer, sizeof (buffer), 0);
+        if (size == -1 && errno == EINTR)
+            continue;
+        if (size == -1 && errno == ENOBUFS) {
+            overflow = true;
+            continue;
+        }
+        if (size <= 0)
+            break;
+        changed = s_apply_buffer (self, buffer, size, NULL) || changed;
+    }
+    if (overflow) {
+        log_warning ("localaddrs: notifications were lost, reading all addresses again");
+        return s_dump (self) || changed;
+    }
+    if (changed)
+        s_index (self);
+    return changed;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Return true if textual address is local
+
+bool
+localaddrs_contains (localaddrs_t *self, const char *address)
+{
+    assert (self);
+    if (!address)
+        return false;
+
+    char text [INET6_ADDRSTRLEN];
+    size_t length = strcspn (address, "%");
+    if (length >= sizeof (text))
+        return false;
+    memcpy (text, address, length);
+    text [length] = 0;
+
+    unsigned char family = strchr (text, ':') ? AF_INET6 : AF_INET;
+    unsigned char addr [16];
+    memset (addr, 0, sizeof (addr));
+    if (inet_pton (family, text, addr) != 1)
+        return false;
+
+    auto it = std::lower_bound (self->addrs.begin (), self->addrs.end (), addr,
+        [family] (const localaddr_t &entry, const unsigned char *key) {
+            return s_compare (family, key, entry) > 0;
+        });
+    return it != self->addrs.end () && s_compare (family, addr, *it) == 0;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Return number of local addresses
+
+size_t
+localaddrs_size (localaddrs_t *self)
+{
+    assert (self);
+    return self->addrs.size ();
+}
+
+
+//  --------------------------------------------------------------------------
+//  Return index-th IPv4 address in interface order
+
+const char *
+localaddrs_ipv4 (localaddrs_t *self, size_t index)
+{
+    assert (self);
+    if (index >= self->ipv4.size ())
+        return NULL;
+    return self->addrs [self->ipv4 [index]].text;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Self test of this class
+
+void
+localaddrs_test (bool verbose)
+{
+    printf (" * localaddrs: ");
+
+    //  @selftest
+    localaddrs_t *self = localaddrs_new (false);
+    assert (self);
+    assert (localaddrs_fd (self) == -1);
+    assert (!localaddrs_update (self));
+
+    // loopback is always there
+    assert (localaddrs_size (self) > 0);
+    assert (localaddrs_contains (self, "127.0.0.1"));
+    assert (localaddrs_contains (self, "127.0.0.1%lo"));
+    assert (!localaddrs_contains (self, "203.0.113.1"));
+    assert (!localaddrs_contains (self, "2001:db8::1"));
+    assert (!localaddrs_contains (self, "not an address"));
+    assert (!localaddrs_contains (self, NULL));
+    assert (localaddrs_ipv4 (self, 0));
+    assert (localaddrs_contains (self, localaddrs_ipv4 (self, 0)));
+    assert (localaddrs_ipv4 (self, localaddrs_size (self)) == NULL);
+
+    // subscribed registry sees the same addresses, nothing is pending
+    localaddrs_t *subscribed = localaddrs_new (true);
+    assert (subscribed);
+    assert (localaddrs_fd (subscribed) != -1);
+    assert (localaddrs_size (subscribed) == localaddrs_size (self));
+    assert (streq (localaddrs_ipv4 (subscribed, 0), localaddrs_ipv4 (self, 0)));
+    assert (!localaddrs_update (subscribed));
+    localaddrs_destroy (&subscribed);
+
+    localaddrs_destroy (&self);
+    assert (self == NULL);
+    //  @end
+    printf ("OK\n");
+}
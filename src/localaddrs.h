@@ -0,0 +1,73 @@
+/*  =========================================================================
+    localaddrs - Registry of local IP addresses maintained from netlink
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#ifndef LOCALADDRS_H_INCLUDED
+#define LOCALADDRS_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  @interface
+//  Create a new localaddrs filled with current addresses. If subscribe is
+//  true, it also listens to address changes, which are applied by update.
+FTY_INFO_PRIVATE localaddrs_t *
+    localaddrs_new (bool subscribe);
+
+//  Destroy the localaddrs
+FTY_INFO_PRIVATE void
+    localaddrs_destroy (localaddrs_t **self_p);
+
+//  Return file descriptor readable when addresses change, -1 if the
+//  registry does not listen to changes
+FTY_INFO_PRIVATE int
+    localaddrs_fd (localaddrs_t *self);
+
+//  Apply all pending address notifications
+//  Return true if set of addresses changed
+FTY_INFO_PRIVATE bool
+    localaddrs_update (localaddrs_t *self);
+
+//  Return true if textual IPv4 or IPv6 address is local. Scope suffix
+//  (like "%eth0") is ignored.
+FTY_INFO_PRIVATE bool
+    localaddrs_contains (localaddrs_t *self, const char *address);
+
+//  Return number of local addresses
+FTY_INFO_PRIVATE size_t
+    localaddrs_size (localaddrs_t *self);
+
+//  Return index-th IPv4 address in interface order, NULL if there are not
+//  so many. String is valid until next update.
+FTY_INFO_PRIVATE const char *
+    localaddrs_ipv4 (localaddrs_t *self, size_t index);
+
+//  Self test of this class
+FTY_INFO_PRIVATE void
+    localaddrs_test (bool verbose);
+
+//  @end
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,744 @@
+/*  =========================================================================
+    metricpublisher - Class for batched publishing of Linux metrics
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    metricpublisher - Class for batched publishing of Linux metrics
+@discuss
+    All metrics of one publishing cycle are collected into a single batch
+    buffer first (type and formatted value of every record are stored one
+    after another) and then committed in one pass. Readers of fty-shm still
+    see one entry per metric, as fty::shm::read_metrics expects.
+
+    Optionally the batch is also pushed to a stream as a single message:
+    METRICS-BATCH, asset and one encoded fty_proto METRIC per frame. As the
+    first frame is not fty_proto, legacy consumers ignore it.
+
+    Values are formatted without heap allocation: integral values are
+    printed as integers, others with the shortest decimal representation
+    which parses back to the same double, unless a fixed precision is set
+    for their unit.
+
+    Every metric type has a publication policy. Value and time of the last
+    published value are kept per type, so a metric whose policy says that
+    nothing interesting changed is not rewritten. Such a metric is written
+    anyway when its stored value would expire before the next cycle.
+@end
+*/
+
+#include <string>
+#include <vector>
+
+#include "fty_info_classes.h"
+
+//  One metric record, offsets point into the batch buffer
+typedef struct {
+    size_t type;
+    size_t value;
+    const char *unit;
+    double raw;
+    bool selected;      // selected for publishing by the last commit
+} metric_record_t;
+
+//  Publication policy of one metric type or prefix
+typedef struct {
+    std::string pattern;
+    bool prefix;
+    metric_policy_t policy;
+    double threshold;
+} metric_policy_entry_t;
+
+//  Last published value of one metric type
+typedef struct {
+    double value;
+    int64_t time;       // monotonic time of last write, in ms
+} metric_state_t;
+
+//  Fixed number of decimals for values of one unit
+typedef struct {
+    std::string unit;
+    int precision;
+} metric_precision_t;
+
+//  Structure of our class
+
+struct _metricpublisher_t {
+    std::string buffer;                     // NUL separated types and values
+    std::vector<metric_record_t> records;   // records of the current batch
+    std::string asset;                      // asset of the last commit
+    std::vector<metric_policy_entry_t> policies;
+    std::vector<metric_precision_t> precisions;
+    zhashx_t *state;                        // type -> metric_state_t
+    int interval;                           // publishing interval, in seconds
+    bool shm;                               // write metrics to fty-shm
+    mlm_client_t *stream;                   // producer on METRICS stream, not owned
+    size_t writes;                          // shm writes done by last commit
+    uint64_t written_total;
+    uint64_t suppressed_total;
+};
+
+static void
+s_state_destructor (void **item)
+{
+    free (*item);
+}
+
+//  Return policy entry for metric type, NULL means METRIC_POLICY_ALWAYS
+static const metric_policy_entry_t *
+s_policy (metricpublisher_t *self, const char *type)
+{
+    const metric_policy_entry_t *best = NULL;
+    for (const auto &entry : self->policies) {
+        if (!entry.prefix) {
+            if (entry.pattern == type)
+                return &entry;
+        }
+        else
+        if (strncmp (type, entry.pattern.c_str (), entry.pattern.size ()) == 0
+        &&  (!best || best->pattern.size () < entry.pattern.size ()))
+            best = &entry;
+    }
+    return best;
+}
+
+//  Return number of decimals for unit, -1 means shortest representation
+static int
+s_precision (metricpublisher_t *self, const char *unit)
+{
+    for (const auto &entry : self->precisions) {
+        if (entry.unit == unit)
+            return entry.precision;
+    }
+    return -1;
+}
+
+//  Write unsigned integer in decimal, return its length
+static int
+s_format_uint (char *buffer, uint64_t value)
+{
+    char digits[20];
+    int len = 0;
+    do {
+        digits[len++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value);
+    for (int i = 0; i < len; i++)
+        buffer[i] = digits[len - 1 - i];
+    buffer[len] = '\0';
+    return len;
+}
+
+//  Does the policy allow to skip the write of this record?
+static bool
+s_suppress (metricpublisher_t *self, const char *type, double value, int ttl, int64_t now)
+{
+    metric_state_t *state = (metric_state_t *) zhashx_lookup (self->state, type);
+    if (!state)
+        return false;
+
+    // refresh values which would expire before next cycle; cycles can come
+    // late by timer slack or a busy actor, so one more interval is spared
+    if ((now - state->time) + 2 * self->interval * 1000 >= (int64_t) ttl * 1000)
+        return false;
+
+    const metric_policy_entry_t *entry = s_policy (self, type);
+    if (!entry)
+        return false;
+
+    double delta = fabs (value - state->value);
+    switch (entry->policy) {
+        case METRIC_POLICY_ON_CHANGE:
+            return value == state->value;
+        case METRIC_POLICY_DEADBAND_ABS:
+            return delta <= entry->threshold;
+        case METRIC_POLICY_DEADBAND_REL:
+            return delta <= entry->threshold * fabs (state->value);
+        default:
+            return false;
+    }
+}
+
+//  Remember value as the last published one
+static void
+s_published (metricpublisher_t *self, const char *type, double value, int64_t now)
+{
+    metric_state_t *state = (metric_state_t *) zhashx_lookup (self->state, type);
+    if (!state) {
+        state = (metric_state_t *) zmalloc (sizeof (metric_state_t));
+        zhashx_insert (self->state, type, state);
+    }
+    state->value = value;
+    state->time = now;
+}
+
+//  Build one stream message with all selected records of the batch
+//    - METRICS-BATCH
+//    - asset
+//    - one fty_proto METRIC frame per record
+static zmsg_t *
+s_stream_message (metricpublisher_t *self, const char *asset, int ttl)
+{
+    zmsg_t *msg = zmsg_new ();
+    zmsg_addstr (msg, METRICS_BATCH_CMD);
+    zmsg_addstr (msg, asset);
+    uint64_t time = (uint64_t) zclock_time () / 1000;
+    for (const auto &record : self->records) {
+        if (!record.selected)
+            continue;
+        zmsg_t *metric = fty_proto_encode_metric (NULL, time, ttl,
+                self->buffer.c_str () + record.type, asset,
+                self->buffer.c_str () + record.value, record.unit);
+        zframe_t *frame = zmsg_pop (metric);
+        zmsg_append (msg, &frame);
+        zmsg_destroy (&metric);
+    }
+    return msg;
+}
+
+//  Find the record of given type in current batch, return -1 if not found
+static ssize_t
+s_find (metricpublisher_t *self, const char *type)
+{
+    for (size_t i = 0; i < self->records.size (); i++) {
+        if (streq (self->buffer.c_str () + self->records[i].type, type))
+            return (ssize_t) i;
+    }
+    return -1;
+}
+
+//  Append NUL terminated string to the batch buffer, return its offset
+static size_t
+s_append (metricpublisher_t *self, const char *str, size_t len)
+{
+    size_t offset = self->buffer.size ();
+    self->buffer.append (str, len);
+    self->buffer.push_back ('\0');
+    return offset;
+}
+
+//  --------------------------------------------------------------------------
+//  Create a new metricpublisher
+
+metricpublisher_t *
+metricpublisher_new (void)
+{
+    metricpublisher_t *self = new metricpublisher_t;
+    assert (self);
+    //  Initialize class properties here
+    self->state = zhashx_new ();
+    zhashx_set_destructor (self->state, s_state_destructor);
+    self->interval = DEFAULT_LINUXMETRICS_INTERVAL_SEC;
+    self->shm = true;
+    self->stream = NULL;
+    self->writes = 0;
+    self->written_total = 0;
+    self->suppressed_total = 0;
+    // a cycle with 10 interfaces has about 70 metrics of about 30 bytes each
+    self->buffer.reserve (4096);
+    self->records.reserve (128);
+    return self;
+}
+
+//  --------------------------------------------------------------------------
+//  Destroy the metricpublisher
+
+void
+metricpublisher_destroy (metricpublisher_t **self_p)
+{
+    assert (self_p);
+    if (*self_p) {
+        metricpublisher_t *self = *self_p;
+        //  Free class properties here
+        zhashx_destroy (&self->state);
+        //  Free object itself
+        delete self;
+        *self_p = NULL;
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Set publication policy for metric type or prefix
+
+void
+metricpublisher_set_policy (metricpublisher_t *self, const char *type, metric_policy_t policy, double threshold)
+{
+    assert (self);
+    if (!type || !*type)
+        return;
+
+    metric_policy_entry_t entry;
+    size_t len = strlen (type);
+    entry.prefix = type[len - 1] == '.';
+    entry.pattern.assign (type);
+    entry.policy = policy;
+    entry.threshold = threshold;
+
+    for (auto &it : self->policies) {
+        if (it.prefix == entry.prefix && it.pattern == entry.pattern) {
+            it = entry;
+            return;
+        }
+    }
+    self->policies.push_back (entry);
+}
+
+//  --------------------------------------------------------------------------
+//  Parse policy name
+
+int
+metricpublisher_policy_from_str (const char *name, metric_policy_t *policy)
+{
+    if (!name || !policy)
+        return -1;
+    if (streq (name, "always"))
+        *policy = METRIC_POLICY_ALWAYS;
+    else
+    if (streq (name, "on_change"))
+        *policy = METRIC_POLICY_ON_CHANGE;
+    else
+    if (streq (name, "deadband_abs"))
+        *policy = METRIC_POLICY_DEADBAND_ABS;
+    else
+    if (streq (name, "deadband_rel"))
+        *policy = METRIC_POLICY_DEADBAND_REL;
+    else
+        return -1;
+    return 0;
+}
+
+//  --------------------------------------------------------------------------
+//  Set fixed number of decimals for values of unit
+
+void
+metricpublisher_set_precision (metricpublisher_t *self, const char *unit, int precision)
+{
+    assert (self);
+    if (!unit)
+        return;
+    for (auto &entry : self->precisions) {
+        if (entry.unit == unit) {
+            entry.precision = precision;
+            return;
+        }
+    }
+    metric_precision_t entry;
+    entry.unit.assign (unit);
+    entry.precision = precision;
+    self->precisions.push_back (entry);
+}
+
+//  --------------------------------------------------------------------------
+//  Format value into buffer
+
+int
+metricpublisher_format (char *buffer, size_t size, double value, int precision)
+{
+    assert (buffer);
+    if (size < METRICPUBLISHER_VALUE_MAX)
+        return -1;
+
+    int len;
+    // 2^53, bigger doubles are not exact integers anymore
+    if (value == trunc (value) && fabs (value) < 9007199254740992.0) {
+        char *p = buffer;
+        if (value < 0)
+            *p++ = '-';
+        len = s_format_uint (p, (uint64_t) fabs (value)) + (int) (p - buffer);
+        return len;
+    }
+
+    if (precision >= 0) {
+        if (precision > 17)
+            precision = 17;
+        len = snprintf (buffer, size, "%.*f", precision, value);
+        if (len >= 0 && len < METRICPUBLISHER_VALUE_MAX)
+            return len;
+        // fixed notation of huge value does not fit, use the shortest exact one
+    }
+
+    // Any decimal of up to 15 significant digits survives a round trip
+    // through double, so if the value has such a representation, %.15g
+    // (which drops trailing zeros) prints exactly the shortest one. The
+    // same holds for 16 digits and 17 digits are always enough.
+    for (int digits = 15; digits <= 17; digits++) {
+        len = snprintf (buffer, size, "%.*g", digits, value);
+        if (len < 0 || len >= (int) size)
+            return -1;
+        if (digits == 17 || strtod (buffer, NULL) == value)
+            break;
+    }
+    return len;
+}
+
+//  --------------------------------------------------------------------------
+//  Set publishing interval (in seconds)
+
+void
+metricpublisher_set_interval (metricpublisher_t *self, int interval)
+{
+    assert (self);
+    if (interval > 0)
+        self->interval = interval;
+}
+
+//  --------------------------------------------------------------------------
+//  Enable or disable fty-shm output
+
+void
+metricpublisher_set_shm (metricpublisher_t *self, bool enabled)
+{
+    assert (self);
+    self->shm = enabled;
+}
+
+//  --------------------------------------------------------------------------
+//  Set client for stream output
+
+void
+metricpublisher_set_stream (metricpublisher_t *self, mlm_client_t *client)
+{
+    assert (self);
+    self->stream = client;
+}
+
+//  --------------------------------------------------------------------------
+//  Start a new batch, records of the previous one are dropped
+
+void
+metricpublisher_begin (metricpublisher_t *self)
+{
+    assert (self);
+    // clear () keeps the capacity, so steady state cycles don't allocate
+    self->buffer.clear ();
+    self->records.clear ();
+}
+
+//  --------------------------------------------------------------------------
+//  Add one metric to the current batch
+
+void
+metricpublisher_add (metricpublisher_t *self, const char *type, double value, const char *unit)
+{
+    assert (self);
+    if (!type || !unit)
+        return;
+
+    char value_str[METRICPUBLISHER_VALUE_MAX];
+    int len = metricpublisher_format (value_str, sizeof (value_str), value, s_precision (self, unit));
+    if (len < 0) {
+        log_error ("Can't format value of metric %s", type);
+        return;
+    }
+
+    ssize_t index = s_find (self, type);
+    if (index >= 0) {
+        // last value wins, old one just stays unused in the buffer
+        self->records[index].value = s_append (self, value_str, len);
+        self->records[index].unit = unit;
+        self->records[index].raw = value;
+        return;
+    }
+
+    metric_record_t record;
+    record.type = s_append (self, type, strlen (type));
+    record.value = s_append (self, value_str, len);
+    record.unit = unit;
+    record.raw = value;
+    record.selected = false;
+    self->records.push_back (record);
+}
+
+//  --------------------------------------------------------------------------
+//  Write records of the current batch to enabled outputs
+
+size_t
+metricpublisher_commit (metricpublisher_t *self, const char *asset, int ttl)
+{
+    assert (self);
+    self->writes = 0;
+    if (!asset)
+        return self->records.size ();
+    self->asset.assign (asset);
+
+    // select records to publish
+    size_t selected = 0;
+    size_t suppressed = 0;
+    int64_t now = zclock_mono ();
+    for (auto &record : self->records) {
+        const char *type = self->buffer.c_str () + record.type;
+        record.selected = !s_suppress (self, type, record.raw, ttl, now);
+        if (record.selected)
+            selected++;
+        else {
+            log_trace ("Metric %s unchanged, not published", type);
+            suppressed++;
+        }
+    }
+
+    size_t failed = 0;
+    if (self->shm) {
+        for (auto &record : self->records) {
+            if (!record.selected)
+                continue;
+            const char *type = self->buffer.c_str () + record.type;
+            const char *value = self->buffer.c_str () + record.value;
+            log_debug ("Publishing metric %s, value %s, unit %s", type, value, record.unit);
+
+            self->writes++;
+            if (fty::shm::write_metric (self->asset, type, value, record.unit, ttl) == 0) {
+                log_trace ("Metric %s published", type);
+            }
+            else {
+                log_error ("Can't publish metric %s", type);
+                record.selected = false;
+                failed++;
+            }
+        }
+    }
+
+    bool streamed = false;
+    if (self->stream && selected && mlm_client_connected (self->stream)) {
+        zmsg_t *msg = s_stream_message (self, asset, ttl);
+        char *subject = zsys_sprintf ("%s@%s", METRICS_BATCH_CMD, asset);
+        streamed = mlm_client_send (self->stream, subject, &msg) == 0;
+        if (!streamed) {
+            log_error ("Can't publish %s on stream", subject);
+            zmsg_destroy (&msg);
+        }
+        zstr_free (&subject);
+    }
+
+    // remember what consumers have seen
+    for (const auto &record : self->records) {
+        if (record.selected && (self->shm || streamed)) {
+            s_published (self, self->buffer.c_str () + record.type, record.raw, now);
+            self->written_total++;
+        }
+    }
+    self->suppressed_total += suppressed;
+    log_debug ("metricpublisher: %zu metrics committed with %zu shm writes%s, %zu suppressed",
+            self->records.size (), self->writes, streamed ? " and one stream message" : "", suppressed);
+    return failed;
+}
+
+//  --------------------------------------------------------------------------
+//  Return number of records in the current batch
+
+size_t
+metricpublisher_size (metricpublisher_t *self)
+{
+    assert (self);
+    return self->records.size ();
+}
+
+//  --------------------------------------------------------------------------
+//  Accessors of records of the current batch
+
+const char *
+metricpublisher_type (metricpublisher_t *self, size_t index)
+{
+    assert (self);
+    assert (index < self->records.size ());
+    return self->buffer.c_str () + self->records [index].type;
+}
+
+const char *
+metricpublisher_value (metricpublisher_t *self, size_t index)
+{
+    assert (self);
+    assert (index < self->records.size ());
+    return self->buffer.c_str () + self->records [index].value;
+}
+
+const char *
+metricpublisher_unit (metricpublisher_t *self, size_t index)
+{
+    assert (self);
+    assert (index < self->records.size ());
+    return self->records [index].unit;
+}
+
+//  --------------------------------------------------------------------------
+//  Return asset of the last commit, empty string before first one
+
+const char *
+metricpublisher_asset (metricpublisher_t *self)
+{
+    assert (self);
+    return self->asset.c_str ();
+}
+
+//  --------------------------------------------------------------------------
+//  Return number of shm writes done by the last commit
+
+size_t
+metricpublisher_writes (metricpublisher_t *self)
+{
+    assert (self);
+    return self->writes;
+}
+
+//  --------------------------------------------------------------------------
+//  Return total number of metrics written since start
+
+uint64_t
+metricpublisher_written_total (metricpublisher_t *self)
+{
+    assert (self);
+    return self->written_total;
+}
+
+//  --------------------------------------------------------------------------
+//  Return total number of metrics suppressed by their policy since start
+
+uint64_t
+metricpublisher_suppressed_total (metricpublisher_t *self)
+{
+    assert (self);
+    return self->suppressed_total;
+}
+
+//  --------------------------------------------------------------------------
+//  Self test of this class
+
+void
+metricpublisher_test (bool verbose)
+{
+    printf (" * metricpublisher: ");
+
+    //  @selftest
+    const char *SELFTEST_DIR_RW = "src/selftest-rw";
+    assert (SELFTEST_DIR_RW);
+    assert (fty_shm_set_test_dir (SELFTEST_DIR_RW) == 0);
+
+    metricpublisher_t *self = metricpublisher_new ();
+    assert (self);
+
+    metricpublisher_begin (self);
+    metricpublisher_add (self, "uptime", 1000, "sec");
+    metricpublisher_add (self, "usage.cpu", 10, "%");
+    // same type in one batch is written only once, with the last value
+    metricpublisher_add (self, "usage.cpu", 50, "%");
+    assert (metricpublisher_size (self) == 2);
+    assert (streq (metricpublisher_type (self, 1), "usage.cpu"));
+    assert (streq (metricpublisher_value (self, 1), "50"));
+    assert (streq (metricpublisher_unit (self, 1), "%"));
+
+    assert (metricpublisher_commit (self, "rackcontroller-0", 90) == 0);
+    assert (metricpublisher_writes (self) == 2);
+    assert (streq (metricpublisher_asset (self), "rackcontroller-0"));
+
+    fty::shm::shmMetrics results;
+    fty::shm::read_metrics ("rackcontroller-0", ".*", results);
+    assert (results.size () == 2);
+    for (auto &metric : results) {
+        if (streq (fty_proto_type (metric), "usage.cpu"))
+            assert (50 == atoi (fty_proto_value (metric)));
+    }
+
+    // new batch starts empty
+    metricpublisher_begin (self);
+    assert (metricpublisher_size (self) == 0);
+
+    // value formatting
+    char buffer[METRICPUBLISHER_VALUE_MAX];
+    assert (metricpublisher_format (buffer, sizeof (buffer), 1024, -1) == 4);
+    assert (streq (buffer, "1024"));
+    metricpublisher_format (buffer, sizeof (buffer), -42, -1);
+    assert (streq (buffer, "-42"));
+    metricpublisher_format (buffer, sizeof (buffer), 0.1, -1);
+    assert (streq (buffer, "0.1"));
+    metricpublisher_format (buffer, sizeof (buffer), 2.0 / 3.0, -1);
+    assert (strtod (buffer, NULL) == 2.0 / 3.0);
+    metricpublisher_format (buffer, sizeof (buffer), 2.0 / 3.0, 2);
+    assert (streq (buffer, "0.67"));
+    // integral values are never printed with decimals
+    metricpublisher_format (buffer, sizeof (buffer), 50, 2);
+    assert (streq (buffer, "50"));
+    // too long fixed notation falls back to the shortest exact one
+    assert (metricpublisher_format (buffer, sizeof (buffer), -999999999999999.5, 17) > 0);
+    assert (strtod (buffer, NULL) == -999999999999999.5);
+    assert (metricpublisher_format (buffer, 4, 1, -1) == -1);
+
+    metricpublisher_set_precision (self, "C", 1);
+    metricpublisher_begin (self);
+    metricpublisher_add (self, "temperature.cpu", 45.25, "C");
+    assert (metricpublisher_commit (self, "rackcontroller-0", 90) == 0);
+    fty::shm::shmMetrics temperature;
+    fty::shm::read_metrics ("rackcontroller-0", "temperature.cpu", temperature);
+    assert (temperature.size () == 1);
+    for (auto &metric : temperature)
+        assert (streq (fty_proto_value (metric), "45.2") || streq (fty_proto_value (metric), "45.3"));
+
+    // policies
+    metric_policy_t policy;
+    assert (metricpublisher_policy_from_str ("on_change", &policy) == 0);
+    assert (policy == METRIC_POLICY_ON_CHANGE);
+    assert (metricpublisher_policy_from_str ("sometimes", &policy) == -1);
+
+    metricpublisher_set_interval (self, 30);
+    metricpublisher_set_policy (self, "uptime", METRIC_POLICY_ON_CHANGE, 0);
+    metricpublisher_set_policy (self, "usage.", METRIC_POLICY_DEADBAND_ABS, 5);
+    // exact type wins over the prefix
+    metricpublisher_set_policy (self, "usage.memory", METRIC_POLICY_ALWAYS, 0);
+    uint64_t written = metricpublisher_written_total (self);
+
+    metricpublisher_begin (self);
+    metricpublisher_add (self, "uptime", 1000, "sec");     // unchanged
+    metricpublisher_add (self, "usage.cpu", 53, "%");      // within deadband
+    metricpublisher_add (self, "usage.memory", 20, "%");   // first value
+    assert (metricpublisher_commit (self, "rackcontroller-0", 90) == 0);
+    assert (metricpublisher_writes (self) == 1);
+    assert (metricpublisher_suppressed_total (self) == 2);
+    assert (metricpublisher_written_total (self) == written + 1);
+
+    metricpublisher_begin (self);
+    metricpublisher_add (self, "uptime", 1000, "sec");     // unchanged
+    metricpublisher_add (self, "usage.cpu", 60, "%");      // out of deadband
+    metricpublisher_add (self, "usage.memory", 20, "%");   // always
+    assert (metricpublisher_commit (self, "rackcontroller-0", 90) == 0);
+    assert (metricpublisher_writes (self) == 2);
+    assert (metricpublisher_suppressed_total (self) == 3);
+
+    // ttl not longer than interval: value would expire, so it is refreshed
+    metricpublisher_begin (self);
+    metricpublisher_add (self, "uptime", 1000, "sec");
+    assert (metricpublisher_commit (self, "rackcontroller-0", 30) == 0);
+    assert (metricpublisher_writes (self) == 1);
+
+    // this cycle comes right after a late one: the value would outlive its
+    // ttl if the next cycle is late too, so it is refreshed
+    metricpublisher_begin (self);
+    metricpublisher_add (self, "uptime", 1000, "sec");
+    assert (metricpublisher_commit (self, "rackcontroller-0", 60) == 0);
+    assert (metricpublisher_writes (self) == 1);
+    // with long enough ttl it is still suppressed
+    metricpublisher_begin (self);
+    metricpublisher_add (self, "uptime", 1000, "sec");
+    assert (metricpublisher_commit (self, "rackcontroller-0", 90) == 0);
+    assert (metricpublisher_writes (self) == 0);
+
+    metricpublisher_destroy (&self);
+    assert (self == NULL);
+    fty_shm_delete_test_dir ();
+    //  @end
+    printf ("OK\n");
+}
@@ -0,0 +1,143 @@
+/*  =========================================================================
+    metricpublisher - Class for batched publishing of Linux metrics
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#ifndef METRICPUBLISHER_H_INCLUDED
+#define METRICPUBLISHER_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define METRICS_BATCH_CMD "METRICS-BATCH"
+//  Size of buffer needed by metricpublisher_format
+#define METRICPUBLISHER_VALUE_MAX 32
+
+//  Publication policies of metrics
+typedef enum {
+    METRIC_POLICY_ALWAYS = 0,   // write every cycle
+    METRIC_POLICY_ON_CHANGE,    // write when value differs from last published one
+    METRIC_POLICY_DEADBAND_ABS, // write when |value - last| > threshold
+    METRIC_POLICY_DEADBAND_REL  // write when |value - last| > threshold * |last|
+} metric_policy_t;
+
+//  @interface
+//  Create a new metricpublisher
+FTY_INFO_PRIVATE metricpublisher_t *
+    metricpublisher_new (void);
+
+//  Destroy the metricpublisher
+FTY_INFO_PRIVATE void
+    metricpublisher_destroy (metricpublisher_t **self_p);
+
+//  Set publication policy for metric type. Type ending with '.' is a prefix
+//  pattern (e.g. "rx_bytes."); exact types take precedence over patterns.
+FTY_INFO_PRIVATE void
+    metricpublisher_set_policy (metricpublisher_t *self, const char *type, metric_policy_t policy, double threshold);
+
+//  Parse policy name (always, on_change, deadband_abs, deadband_rel)
+//  Return 0 on success, -1 if name is unknown
+FTY_INFO_PRIVATE int
+    metricpublisher_policy_from_str (const char *name, metric_policy_t *policy);
+
+//  Set fixed number of decimals for values of unit, -1 (default) means the
+//  shortest representation which parses back to the same value. Integral
+//  values are always printed without decimals.
+FTY_INFO_PRIVATE void
+    metricpublisher_set_precision (metricpublisher_t *self, const char *unit, int precision);
+
+//  Format value into buffer of at least METRICPUBLISHER_VALUE_MAX bytes
+//  Return length of the string, or -1 on error
+FTY_INFO_PRIVATE int
+    metricpublisher_format (char *buffer, size_t size, double value, int precision);
+
+//  Set publishing interval (in seconds). A suppressed metric is written
+//  anyway when it would expire (its ttl) before the cycle after the next
+//  one, so that a late cycle still comes in time.
+FTY_INFO_PRIVATE void
+    metricpublisher_set_interval (metricpublisher_t *self, int interval);
+
+//  Enable or disable fty-shm output, enabled by default
+FTY_INFO_PRIVATE void
+    metricpublisher_set_shm (metricpublisher_t *self, bool enabled);
+
+//  Set client which is producer on the stream where each batch is sent
+//  as one message, NULL (default) disables stream output
+FTY_INFO_PRIVATE void
+    metricpublisher_set_stream (metricpublisher_t *self, mlm_client_t *client);
+
+//  Start a new batch, records of the previous one are dropped
+FTY_INFO_PRIVATE void
+    metricpublisher_begin (metricpublisher_t *self);
+
+//  Add one metric to the current batch. Value is formatted into the batch
+//  buffer; a type already present in the batch is overwritten.
+FTY_INFO_PRIVATE void
+    metricpublisher_add (metricpublisher_t *self, const char *type, double value, const char *unit);
+
+//  Write records of the current batch for asset to enabled outputs, records
+//  which their policy suppresses are skipped
+//  Return number of records which could not be written
+FTY_INFO_PRIVATE size_t
+    metricpublisher_commit (metricpublisher_t *self, const char *asset, int ttl);
+
+//  Return number of records in the current batch
+FTY_INFO_PRIVATE size_t
+    metricpublisher_size (metricpublisher_t *self);
+
+//  Return type of index-th record of the current batch
+FTY_INFO_PRIVATE const char *
+    metricpublisher_type (metricpublisher_t *self, size_t index);
+
+//  Return formatted value of index-th record of the current batch
+FTY_INFO_PRIVATE const char *
+    metricpublisher_value (metricpublisher_t *self, size_t index);
+
+//  Return unit of index-th record of the current batch
+FTY_INFO_PRIVATE const char *
+    metricpublisher_unit (metricpublisher_t *self, size_t index);
+
+//  Return asset of the last commit, empty string before the first one
+FTY_INFO_PRIVATE const char *
+    metricpublisher_asset (metricpublisher_t *self);
+
+//  Return number of shm writes done by the last commit
+FTY_INFO_PRIVATE size_t
+    metricpublisher_writes (metricpublisher_t *self);
+
+//  Return total number of metrics published since start
+FTY_INFO_PRIVATE uint64_t
+    metricpublisher_written_total (metricpublisher_t *self);
+
+//  Return total number of metrics suppressed by their policy since start
+FTY_INFO_PRIVATE uint64_t
+    metricpublisher_suppressed_total (metricpublisher_t *self);
+
+//  Self test of this class
+FTY_INFO_PRIVATE void
+    metricpublisher_test (bool verbose);
+
+//  @end
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
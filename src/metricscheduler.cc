@@ -0,0 +1,311 @@
+/*  =========================================================================
+    metricscheduler - Timer scheduling publishing of Linux metrics
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    metricscheduler - Timer scheduling publishing of Linux metrics
+@discuss
+    Wraps a timerfd armed on absolute monotonic deadlines. Deadline n is
+    always start + n * interval, so time spent handling a tick does not
+    shift the following ones. When the owner comes too late and deadlines
+    were missed, they are coalesced into a single tick and counted as
+    overruns; lateness of each tick is accounted as well.
+
+    All functions take the current time as argument, so the schedule can
+    be driven by a virtual clock in tests.
+@end
+*/
+
+#include <sys/timerfd.h>
+#include <sys/prctl.h>
+
+#include "fty_info_classes.h"
+
+//  Structure of our class
+
+struct _metricscheduler_t {
+    int fd;                     //  timerfd
+    int interval;               //  in ms, 0 when stopped
+    int slack;                  //  in ms
+    int64_t deadline;           //  next ideal deadline
+    uint64_t ticks;
+    uint64_t overruns;
+    int64_t lateness;
+    int64_t lateness_max;
+    uint64_t lateness_total;
+};
+
+
+//  --------------------------------------------------------------------------
+//  Arm timerfd on absolute time (monotonic ms), 0 disarms it
+
+static void
+s_arm (metricscheduler_t *self, int64_t time)
+{
+    struct itimerspec spec;
+    memset (&spec, 0, sizeof (spec));
+    if (time > 0) {
+        spec.it_value.tv_sec = time / 1000;
+        spec.it_value.tv_nsec = (time % 1000) * 1000000;
+    }
+    else
+    if (self->interval > 0)
+        spec.it_value.tv_nsec = 1;  // already in the past, fire now
+    if (timerfd_settime (self->fd, TFD_TIMER_ABSTIME, &spec, NULL) == -1)
+        log_error ("metricscheduler: cannot arm timer: %s", strerror (errno));
+}
+
+
+//  --------------------------------------------------------------------------
+//  Arm timer on next deadline, rounded up to multiple of slack
+
+static void
+s_arm_deadline (metricscheduler_t *self)
+{
+    int64_t time = self->deadline;
+    if (self->slack > 0 && time % self->slack)
+        time += self->slack - time % self->slack;
+    s_arm (self, time);
+}
+
+
+//  --------------------------------------------------------------------------
+//  Create a new metricscheduler
+
+metricscheduler_t *
+metricscheduler_new (void)
+{
+    metricscheduler_t *self = (metricscheduler_t *) zmalloc (sizeof (metricscheduler_t));
+    assert (self);
+    self->fd = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    assert (self->fd != -1);
+    self->deadline = -1;
+    return self;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Destroy the metricscheduler
+
+void
+metricscheduler_destroy (metricscheduler_t **self_p)
+{
+    assert (self_p);
+    if (*self_p) {
+        metricscheduler_t *self = *self_p;
+        close (self->fd);
+        free (self);
+        *self_p = NULL;
+    }
+}
+
+
+//  --------------------------------------------------------------------------
+//  Return file descriptor which becomes readable when a tick is due
+
+int
+metricscheduler_fd (metricscheduler_t *self)
+{
+    assert (self);
+    return self->fd;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Set timer slack (in ms)
+
+void
+metricscheduler_set_slack (metricscheduler_t *self, int slack)
+{
+    assert (self);
+    self->slack = slack > 0 ? slack : 0;
+    // poll timeouts of the calling (actor) thread get the same slack,
+    // 0 restores default slack of the thread
+    prctl (PR_SET_TIMERSLACK, (unsigned long) self->slack * 1000000UL, 0, 0, 0);
+    if (self->interval > 0)
+        s_arm_deadline (self);
+}
+
+
+//  --------------------------------------------------------------------------
+//  Start ticking each interval (in ms)
+
+void
+metricscheduler_start (metricscheduler_t *self, int interval, int64_t now)
+{
+    assert (self);
+    if (interval <= 0) {
+        log_error ("metricscheduler: invalid interval %d", interval);
+        return;
+    }
+    self->interval = interval;
+    self->deadline = now + interval;
+    s_arm_deadline (self);
+}
+
+
+//  --------------------------------------------------------------------------
+//  Stop the timer
+
+void
+metricscheduler_stop (metricscheduler_t *self)
+{
+    assert (self);
+    self->interval = 0;
+    self->deadline = -1;
+    s_arm (self, 0);
+}
+
+
+//  --------------------------------------------------------------------------
+//  Handle expiration of the timer at time now
+
+bool
+metricscheduler_expire (metricscheduler_t *self, int64_t now)
+{
+    assert (self);
+    // consume expiration, it may be absent when driven by virtual clock
+    uint64_t expirations;
+    if (read (self->fd, &expirations, sizeof (expirations)) == -1 && errno != EAGAIN)
+        log_error ("metricscheduler: cannot read timer: %s", strerror (errno));
+
+    if (self->interval <= 0 || now < self->deadline)
+        return false;
+
+    int64_t missed = (now - self->deadline) / self->interval;
+    self->lateness = now - self->deadline;
+    if (self->lateness > self->lateness_max)
+        self->lateness_max = self->lateness;
+    self->lateness_total += self->lateness;
+    self->overruns += missed;
+    self->ticks++;
+    if (missed)
+        log_warning ("metricscheduler: tick late by %lld ms, %lld deadlines skipped",
+                (long long) self->lateness, (long long) missed);
+
+    self->deadline += (missed + 1) * self->interval;
+    s_arm_deadline (self);
+    return true;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Return next deadline, or -1 if stopped
+
+int64_t
+metricscheduler_deadline (metricscheduler_t *self)
+{
+    assert (self);
+    return self->deadline;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Accessors of counters
+
+uint64_t
+metricscheduler_ticks (metricscheduler_t *self)
+{
+    assert (self);
+    return self->ticks;
+}
+
+uint64_t
+metricscheduler_overruns (metricscheduler_t *self)
+{
+    assert (self);
+    return self->overruns;
+}
+
+int64_t
+metricscheduler_lateness (metricscheduler_t *self)
+{
+    assert (self);
+    return self->lateness;
+}
+
+int64_t
+metricscheduler_lateness_max (metricscheduler_t *self)
+{
+    assert (self);
+    return self->lateness_max;
+}
+
+uint64_t
+metricscheduler_lateness_total (metricscheduler_t *self)
+{
+    assert (self);
+    return self->lateness_total;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Self test of this class
+
+void
+metricscheduler_test (bool verbose)
+{
+    printf (" * metricscheduler: ");
+
+    //  @selftest
+    metricscheduler_t *self = metricscheduler_new ();
+    assert (self);
+    assert (metricscheduler_deadline (self) == -1);
+
+    // virtual clock
+    metricscheduler_start (self, 100, 1000);
+    assert (metricscheduler_deadline (self) == 1100);
+    assert (!metricscheduler_expire (self, 1050));     // spurious
+    assert (metricscheduler_expire (self, 1100));
+    assert (metricscheduler_lateness (self) == 0);
+    assert (metricscheduler_deadline (self) == 1200);
+
+    // late tick does not shift following deadlines
+    assert (metricscheduler_expire (self, 1230));
+    assert (metricscheduler_lateness (self) == 30);
+    assert (metricscheduler_deadline (self) == 1300);
+
+    // missed deadlines 1400 and 1500 are coalesced into one tick
+    assert (metricscheduler_expire (self, 1555));
+    assert (metricscheduler_overruns (self) == 2);
+    assert (metricscheduler_lateness (self) == 255);
+    assert (metricscheduler_lateness_max (self) == 255);
+    assert (metricscheduler_lateness_total (self) == 285);
+    assert (metricscheduler_deadline (self) == 1600);
+    assert (metricscheduler_ticks (self) == 3);
+
+    metricscheduler_stop (self);
+    assert (!metricscheduler_expire (self, 2000));
+    assert (metricscheduler_ticks (self) == 3);
+
+    // real clock, the descriptor becomes readable
+    metricscheduler_set_slack (self, 5);
+    metricscheduler_start (self, 10, zclock_mono ());
+    zmq_pollitem_t item = { NULL, metricscheduler_fd (self), ZMQ_POLLIN, 0 };
+    assert (zmq_poll (&item, 1, 1000) == 1);
+    assert (metricscheduler_expire (self, zclock_mono ()));
+    assert (metricscheduler_ticks (self) == 4);
+
+    metricscheduler_destroy (&self);
+    assert (self == NULL);
+    //  @end
+    printf ("OK\n");
+}
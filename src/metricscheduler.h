@@ -0,0 +1,96 @@
+/*  =========================================================================
+    metricscheduler - Timer scheduling publishing of Linux metrics
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#ifndef METRICSCHEDULER_H_INCLUDED
+#define METRICSCHEDULER_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  @interface
+//  Create a new metricscheduler, timer is stopped
+FTY_INFO_PRIVATE metricscheduler_t *
+    metricscheduler_new (void);
+
+//  Destroy the metricscheduler
+FTY_INFO_PRIVATE void
+    metricscheduler_destroy (metricscheduler_t **self_p);
+
+//  Return file descriptor which becomes readable when a tick is due
+FTY_INFO_PRIVATE int
+    metricscheduler_fd (metricscheduler_t *self);
+
+//  Set timer slack (in ms), deadlines are armed on multiples of slack so
+//  wakeups can be coalesced with other timers. 0 (default) disables it.
+FTY_INFO_PRIVATE void
+    metricscheduler_set_slack (metricscheduler_t *self, int slack);
+
+//  Start ticking each interval (in ms), first deadline is now + interval.
+//  Times are monotonic ms (zclock_mono); tests may pass a virtual clock.
+FTY_INFO_PRIVATE void
+    metricscheduler_start (metricscheduler_t *self, int interval, int64_t now);
+
+//  Stop the timer
+FTY_INFO_PRIVATE void
+    metricscheduler_stop (metricscheduler_t *self);
+
+//  Handle expiration of the timer at time now. Deadlines missed meanwhile
+//  are coalesced into one tick and counted as overruns.
+//  Return true if a tick is due, false on spurious wakeup
+FTY_INFO_PRIVATE bool
+    metricscheduler_expire (metricscheduler_t *self, int64_t now);
+
+//  Return next deadline (monotonic ms), or -1 if stopped
+FTY_INFO_PRIVATE int64_t
+    metricscheduler_deadline (metricscheduler_t *self);
+
+//  Return number of ticks since start
+FTY_INFO_PRIVATE uint64_t
+    metricscheduler_ticks (metricscheduler_t *self);
+
+//  Return number of deadlines skipped because previous tick was too late
+FTY_INFO_PRIVATE uint64_t
+    metricscheduler_overruns (metricscheduler_t *self);
+
+//  Return lateness of the last tick (in ms)
+FTY_INFO_PRIVATE int64_t
+    metricscheduler_lateness (metricscheduler_t *self);
+
+//  Return maximal lateness of a tick (in ms)
+FTY_INFO_PRIVATE int64_t
+    metricscheduler_lateness_max (metricscheduler_t *self);
+
+//  Return sum of lateness of all ticks (in ms)
+FTY_INFO_PRIVATE uint64_t
+    metricscheduler_lateness_total (metricscheduler_t *self);
+
+//  Self test of this class
+FTY_INFO_PRIVATE void
+    metricscheduler_test (bool verbose);
+
+//  @end
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,533 @@
+/*  =========================================================================
+    metricsexporter - OpenMetrics exposition of Linux metrics and INFO on a local socket
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    metricsexporter - OpenMetrics exposition of Linux metrics and INFO on a local socket
+@discuss
+    Minimal HTTP/1.1 responder for local scrapers (node exporter sidecar,
+    curl --unix-socket). Each connection carries one request and is closed
+    after the response. The owner polls the listening descriptor, accepts
+    the connection and renders its in-memory state into the exposition
+    buffer, which is reused between scrapes.
+
+    Reading the request and writing the response each block for at most
+    METRICSEXPORTER_TIMEOUT_MS in total, however slowly the client sends
+    or receives; clients are expected to be local.
+@end
+*/
+
+#include <string>
+#include <cmath>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#include "fty_info_classes.h"
+
+#define METRICSEXPORTER_TIMEOUT_MS 200
+#define METRICSEXPORTER_CONTENT_TYPE "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+//  Structure of our class
+
+struct _metricsexporter_t {
+    int fd;                 //  listening socket
+    char *path;             //  socket file to remove, NULL for abstract one
+    std::string body;       //  exposition, reused between scrapes
+    bool labels;            //  current sample has labels
+    bool head;              //  pending request is HEAD
+    uint64_t scrapes;
+};
+
+
+//  --------------------------------------------------------------------------
+//  Create a new metricsexporter
+
+metricsexporter_t *
+metricsexporter_new (const char *path)
+{
+    assert (path);
+    struct sockaddr_un addr;
+    memset (&addr, 0, sizeof (addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen (path) < 2 || strlen (path) >= sizeof (addr.sun_path)) {
+        log_error ("metricsexporter: invalid socket path '%s'", path);
+        return NULL;
+    }
+    bool abstract = path [0] == '@';
+    memcpy (addr.sun_path, path, strlen (path));
+    if (abstract)
+        addr.sun_path [0] = '\0';
+    socklen_t addrlen = (socklen_t) (offsetof (struct sockaddr_un, sun_path) + strlen (path));
+
+    int fd = socket (AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        log_error ("metricsexporter: cannot create socket: %s", strerror (errno));
+        return NULL;
+    }
+    if (!abstract)
+        unlink (path);      // stale socket of previous run
+    if (bind (fd, (struct sockaddr *) &addr, addrlen) == -1
+    ||  listen (fd, 8) == -1) {
+        log_error ("metricsexporter: cannot listen on %s: %s", path, strerror (errno));
+        close (fd);
+        return NULL;
+    }
+
+    metricsexporter_t *self = new metricsexporter_t;
+    assert (self);
+    self->fd = fd;
+    self->path = abstract ? NULL : strdup (path);
+    self->labels = false;
+    self->head = false;
+    self->scrapes = 0;
+    log_info ("metricsexporter: serving metrics on %s", path);
+    return self;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Destroy the metricsexporter
+
+void
+metricsexporter_destroy (metricsexporter_t **self_p)
+{
+    assert (self_p);
+    if (*self_p) {
+        metricsexporter_t *self = *self_p;
+        close (self->fd);
+        if (self->path)
+            unlink (self->path);
+        zstr_free (&self->path);
+        delete self;
+        *self_p = NULL;
+    }
+}
+
+
+//  --------------------------------------------------------------------------
+//  Return listening file descriptor
+
+int
+metricsexporter_fd (metricsexporter_t *self)
+{
+    assert (self);
+    return self->fd;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Limit next blocking call of socket option (SO_RCVTIMEO or SO_SNDTIMEO)
+//  to time left until deadline. Return false if it passed already.
+
+static bool
+s_time_left (int fd, int option, int64_t deadline)
+{
+    int64_t left = deadline - zclock_mono ();
+    if (left <= 0) {
+        errno = ETIMEDOUT;
+        return false;
+    }
+    struct timeval timeout = { (time_t) (left / 1000), (suseconds_t) (left % 1000) * 1000 };
+    setsockopt (fd, SOL_SOCKET, option, &timeout, sizeof (timeout));
+    return true;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Write whole header and body to connection, without SIGPIPE, within
+//  METRICSEXPORTER_TIMEOUT_MS
+
+static int
+s_write (int fd, const char *header, size_t header_size, const char *body, size_t body_size)
+{
+    int64_t deadline = zclock_mono () + METRICSEXPORTER_TIMEOUT_MS;
+    struct iovec iov [2] = {
+        { (void *) header, header_size },
+        { (void *) body, body_size }
+    };
+    struct msghdr msg;
+    memset (&msg, 0, sizeof (msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    while (iov [0].iov_len + iov [1].iov_len > 0) {
+        if (!s_time_left (fd, SO_SNDTIMEO, deadline))
+            return -1;
+        ssize_t sent = sendmsg (fd, &msg, MSG_NOSIGNAL);
+        if (sent == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        for (int i = 0; i < 2; i++) {
+            size_t n = (size_t) sent < iov [i].iov_len ? (size_t) sent : iov [i].iov_len;
+            iov [i].iov_base = (char *) iov [i].iov_base + n;
+            iov [i].iov_len -= n;
+            sent -= n;
+        }
+    }
+    return 0;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Send error response without body and close the connection
+
+static void
+s_error (int fd, const char *status)
+{
+    char header [256];
+    int len = snprintf (header, sizeof (header),
+            "HTTP/1.1 %s\r\n%sContent-Length: 0\r\nConnection: close\r\n\r\n",
+            status, strncmp (status, "405", 3) == 0 ? "Allow: GET, HEAD\r\n" : "");
+    s_write (fd, header, (size_t) len, NULL, 0);
+    close (fd);
+}
+
+
+//  --------------------------------------------------------------------------
+//  Accept one connection and read its request
+
+int
+metricsexporter_accept (metricsexporter_t *self)
+{
+    assert (self);
+    int fd = accept4 (self->fd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            log_error ("metricsexporter: accept failed: %s", strerror (errno));
+        return -1;
+    }
+
+    // only request line matters, read until end of headers; the deadline
+    // is for the whole request, not for each recv
+    int64_t deadline = zclock_mono () + METRICSEXPORTER_TIMEOUT_MS;
+    char request [2048];
+    size_t size = 0;
+    while (size < sizeof (request) - 1) {
+        if (!s_time_left (fd, SO_RCVTIMEO, deadline))
+            break;
+        ssize_t rc = recv (fd, request + size, sizeof (request) - 1 - size, 0);
+        if (rc == -1 && errno == EINTR)
+            continue;
+        if (rc <= 0)
+            break;
+        size += (size_t) rc;
+        request [size] = '\0';
+        if (strstr (request, "\r\n\r\n"))
+            break;
+    }
+    request [size] = '\0';
+
+    char *line_end = strstr (request, "\r\n");
+    if (!line_end) {
+        s_error (fd, "400 Bad Request");
+        return -1;
+    }
+    *line_end = '\0';
+    char *target = strchr (request, ' ');
+    char *version = target ? strchr (target + 1, ' ') : NULL;
+    if (!version || strncmp (version + 1, "HTTP/1.", 7) != 0) {
+        s_error (fd, "400 Bad Request");
+        return -1;
+    }
+    *target++ = '\0';
+    *version = '\0';
+    char *query = strchr (target, '?');
+    if (query)
+        *query = '\0';
+
+    if (!streq (request, "GET") && !streq (request, "HEAD")) {
+        s_error (fd, "405 Method Not Allowed");
+        return -1;
+    }
+    if (!streq (target, "/metrics") && !streq (target, "/")) {
+        s_error (fd, "404 Not Found");
+        return -1;
+    }
+    self->head = streq (request, "HEAD");
+    return fd;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Start a new exposition
+
+void
+metricsexporter_begin (metricsexporter_t *self)
+{
+    assert (self);
+    self->body.clear ();
+    self->labels = false;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Add metadata of metric family
+
+void
+metricsexporter_family (metricsexporter_t *self, const char *name, const char *type, const char *help)
+{
+    assert (self);
+    assert (name);
+    assert (type);
+    self->body.append ("# TYPE ").append (name).append (" ").append (type).append ("\n");
+    if (help)
+        self->body.append ("# HELP ").append (name).append (" ").append (help).append ("\n");
+}
+
+
+//  --------------------------------------------------------------------------
+//  Start a sample of metric name
+
+void
+metricsexporter_sample (metricsexporter_t *self, const char *name)
+{
+    assert (self);
+    assert (name);
+    self->body.append (name);
+    self->labels = false;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Add label to the current sample
+
+void
+metricsexporter_label (metricsexporter_t *self, const char *name, const char *value)
+{
+    assert (self);
+    assert (name);
+    self->body.push_back (self->labels ? ',' : '{');
+    // INFO keys like "name-uri" or "ip.1" are not valid label names
+    for (const char *c = name; *c; c++)
+        self->body.push_back (isalnum ((unsigned char) *c) ? *c : '_');
+    self->body.append ("=\"");
+    for (const char *c = value ? value : ""; *c; c++) {
+        switch (*c) {
+            case '\\': self->body.append ("\\\\"); break;
+            case '"':  self->body.append ("\\\""); break;
+            case '\n': self->body.append ("\\n"); break;
+            default:   self->body.push_back (*c);
+        }
+    }
+    self->body.push_back ('"');
+    self->labels = true;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Add le label of histogram bucket to the current sample
+
+void
+metricsexporter_label_bound (metricsexporter_t *self, double bound)
+{
+    assert (self);
+    char le [METRICPUBLISHER_VALUE_MAX + 2] = "+Inf";
+    if (!std::isinf (bound)) {
+        int len = metricpublisher_format (le, sizeof (le), bound, -1);
+        assert (len > 0);
+        // integral values are written without decimals
+        if (!strpbrk (le, ".e"))
+            strcpy (le + len, ".0");
+    }
+    metricsexporter_label (self, "le", le);
+}
+
+
+//  --------------------------------------------------------------------------
+//  Finish the current sample with value
+
+void
+metricsexporter_value (metricsexporter_t *self, const char *value)
+{
+    assert (self);
+    assert (value);
+    if (self->labels)
+        self->body.push_back ('}');
+    self->body.push_back (' ');
+    // printf spelling of special values differs from OpenMetrics one
+    if (streq (value, "nan") || streq (value, "-nan"))
+        self->body.append ("NaN");
+    else
+    if (streq (value, "inf"))
+        self->body.append ("+Inf");
+    else
+    if (streq (value, "-inf"))
+        self->body.append ("-Inf");
+    else
+        self->body.append (value);
+    self->body.push_back ('\n');
+    self->labels = false;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Send the exposition as response to connection fd and close it
+
+int
+metricsexporter_send (metricsexporter_t *self, int fd)
+{
+    assert (self);
+    self->body.append ("# EOF\n");
+
+    char header [256];
+    int len = snprintf (header, sizeof (header),
+            "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+            METRICSEXPORTER_CONTENT_TYPE, self->body.size ());
+    int rv = s_write (fd, header, (size_t) len,
+            self->body.data (), self->head ? 0 : self->body.size ());
+    if (rv == -1)
+        log_warning ("metricsexporter: cannot send response: %s", strerror (errno));
+    else
+        self->scrapes++;
+    close (fd);
+    return rv;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Return number of served expositions
+
+uint64_t
+metricsexporter_scrapes (metricsexporter_t *self)
+{
+    assert (self);
+    return self->scrapes;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Connect to path and send request, return the client socket
+
+static int
+s_test_request (const char *path, const char *request)
+{
+    int fd = socket (AF_UNIX, SOCK_STREAM, 0);
+    assert (fd != -1);
+    struct sockaddr_un addr;
+    memset (&addr, 0, sizeof (addr));
+    addr.sun_family = AF_UNIX;
+    strncpy (addr.sun_path, path, sizeof (addr.sun_path) - 1);
+    assert (connect (fd, (struct sockaddr *) &addr, sizeof (addr)) == 0);
+    assert (send (fd, request, strlen (request), 0) == (ssize_t) strlen (request));
+    return fd;
+}
+
+//  Read whole response and close the client socket
+
+static std::string
+s_test_response (int fd)
+{
+    std::string response;
+    char buffer [512];
+    ssize_t rc;
+    while ((rc = recv (fd, buffer, sizeof (buffer), 0)) > 0)
+        response.append (buffer, (size_t) rc);
+    close (fd);
+    return response;
+}
+
+//  --------------------------------------------------------------------------
+//  Self test of this class
+
+void
+metricsexporter_test (bool verbose)
+{
+    printf (" * metricsexporter: ");
+
+    //  @selftest
+    const char *SELFTEST_DIR_RW = "src/selftest-rw";
+    assert (SELFTEST_DIR_RW);
+    zsys_dir_create (SELFTEST_DIR_RW);
+    char *path = zsys_sprintf ("%s/metrics.sock", SELFTEST_DIR_RW);
+
+    assert (metricsexporter_new ("") == NULL);
+    metricsexporter_t *self = metricsexporter_new (path);
+    assert (self);
+    zmq_pollitem_t item = { NULL, metricsexporter_fd (self), ZMQ_POLLIN, 0 };
+
+    // valid scrape
+    int client = s_test_request (path, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    assert (zmq_poll (&item, 1, 1000) == 1);
+    int fd = metricsexporter_accept (self);
+    assert (fd != -1);
+    metricsexporter_begin (self);
+    metricsexporter_family (self, "fty_info_linux_metric", "gauge", "Linux system metrics");
+    metricsexporter_sample (self, "fty_info_linux_metric");
+    metricsexporter_label (self, "type", "usage.cpu");
+    metricsexporter_label (self, "unit-name", "\"%\"");
+    metricsexporter_value (self, "12.5");
+    metricsexporter_sample (self, "fty_info_scrapes_total");
+    metricsexporter_value (self, "nan");
+    metricsexporter_sample (self, "fty_info_latency_seconds_bucket");
+    metricsexporter_label_bound (self, 1);
+    metricsexporter_value (self, "1");
+    metricsexporter_sample (self, "fty_info_latency_seconds_bucket");
+    metricsexporter_label_bound (self, 0.25);
+    metricsexporter_value (self, "1");
+    metricsexporter_sample (self, "fty_info_latency_seconds_bucket");
+    metricsexporter_label_bound (self, INFINITY);
+    metricsexporter_value (self, "1");
+    assert (metricsexporter_send (self, fd) == 0);
+    std::string response = s_test_response (client);
+    assert (response.find ("HTTP/1.1 200 OK\r\n") == 0);
+    assert (response.find ("Content-Type: " METRICSEXPORTER_CONTENT_TYPE) != std::string::npos);
+    assert (response.find ("# TYPE fty_info_linux_metric gauge\n") != std::string::npos);
+    assert (response.find ("fty_info_linux_metric{type=\"usage.cpu\",unit_name=\"\\\"%\\\"\"} 12.5\n") != std::string::npos);
+    assert (response.find ("fty_info_scrapes_total NaN\n") != std::string::npos);
+    assert (response.find ("fty_info_latency_seconds_bucket{le=\"1.0\"} 1\n") != std::string::npos);
+    assert (response.find ("fty_info_latency_seconds_bucket{le=\"0.25\"} 1\n") != std::string::npos);
+    assert (response.find ("fty_info_latency_seconds_bucket{le=\"+Inf\"} 1\n") != std::string::npos);
+    assert (response.rfind ("# EOF\n") == response.size () - 6);
+    assert (metricsexporter_scrapes (self) == 1);
+
+    // unknown target is refused by accept itself
+    client = s_test_request (path, "GET /other HTTP/1.1\r\n\r\n");
+    assert (zmq_poll (&item, 1, 1000) == 1);
+    assert (metricsexporter_accept (self) == -1);
+    response = s_test_response (client);
+    assert (response.find ("HTTP/1.1 404 Not Found\r\n") == 0);
+
+    client = s_test_request (path, "POST /metrics HTTP/1.1\r\n\r\n");
+    assert (zmq_poll (&item, 1, 1000) == 1);
+    assert (metricsexporter_accept (self) == -1);
+    response = s_test_response (client);
+    assert (response.find ("HTTP/1.1 405 Method Not Allowed\r\n") == 0);
+    assert (metricsexporter_scrapes (self) == 1);
+
+    // incomplete request does not block longer than the timeout
+    client = s_test_request (path, "GET /met");
+    assert (zmq_poll (&item, 1, 1000) == 1);
+    int64_t start = zclock_mono ();
+    assert (metricsexporter_accept (self) == -1);
+    assert (zclock_mono () - start < 2 * METRICSEXPORTER_TIMEOUT_MS);
+    response = s_test_response (client);
+    assert (response.find ("HTTP/1.1 400 Bad Request\r\n") == 0);
+
+    metricsexporter_destroy (&self);
+    assert (self == NULL);
+    assert (!zsys_file_exists (path));
+    zstr_free (&path);
+    //  @end
+    printf ("OK\n");
+}
@@ -0,0 +1,94 @@
+/*  =========================================================================
+    metricsexporter - OpenMetrics exposition of Linux metrics and INFO on a local socket
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#ifndef METRICSEXPORTER_H_INCLUDED
+#define METRICSEXPORTER_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  @interface
+//  Create a new metricsexporter listening on UNIX socket path, path starting
+//  with '@' is an abstract socket. Return NULL if socket can't be created.
+FTY_INFO_PRIVATE metricsexporter_t *
+    metricsexporter_new (const char *path);
+
+//  Destroy the metricsexporter, socket file is removed
+FTY_INFO_PRIVATE void
+    metricsexporter_destroy (metricsexporter_t **self_p);
+
+//  Return listening file descriptor, readable when a client connects
+FTY_INFO_PRIVATE int
+    metricsexporter_fd (metricsexporter_t *self);
+
+//  Accept one connection and read its request. Requests other than GET or
+//  HEAD of /metrics are answered with an error right away.
+//  Return descriptor of connection which awaits the exposition, or -1
+FTY_INFO_PRIVATE int
+    metricsexporter_accept (metricsexporter_t *self);
+
+//  Start a new exposition, the buffer is reused
+FTY_INFO_PRIVATE void
+    metricsexporter_begin (metricsexporter_t *self);
+
+//  Add metadata of metric family, help may be NULL
+FTY_INFO_PRIVATE void
+    metricsexporter_family (metricsexporter_t *self, const char *name, const char *type, const char *help);
+
+//  Start a sample of metric name
+FTY_INFO_PRIVATE void
+    metricsexporter_sample (metricsexporter_t *self, const char *name);
+
+//  Add label to the current sample, value is escaped and characters not
+//  allowed in label name are replaced by '_'
+FTY_INFO_PRIVATE void
+    metricsexporter_label (metricsexporter_t *self, const char *name, const char *value);
+
+//  Add le label of histogram bucket to the current sample, bound is written
+//  in canonical form, with at least one decimal ("1.0") or as "+Inf"
+FTY_INFO_PRIVATE void
+    metricsexporter_label_bound (metricsexporter_t *self, double bound);
+
+//  Finish the current sample with value
+FTY_INFO_PRIVATE void
+    metricsexporter_value (metricsexporter_t *self, const char *value);
+
+//  Send the exposition as response to connection fd and close it
+//  Return 0 on success, -1 on error
+FTY_INFO_PRIVATE int
+    metricsexporter_send (metricsexporter_t *self, int fd);
+
+//  Return number of served expositions
+FTY_INFO_PRIVATE uint64_t
+    metricsexporter_scrapes (metricsexporter_t *self);
+
+//  Self test of this class
+FTY_INFO_PRIVATE void
+    metricsexporter_test (bool verbose);
+
+//  @end
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,372 @@
+/*  =========================================================================
+    releasedetails - Cache of parsed release details
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    releasedetails - Cache of parsed release details
+@discuss
+    /etc/release-details.json changes only on firmware upgrade, so it is
+    parsed once into typed fields. Refresh compares device, inode, size and
+    modification time of the file with the parsed one and parses it again
+    only if they differ (the file is usually replaced by rename).
+@end
+*/
+
+#include <string>
+#include <fstream>
+#include <sys/stat.h>
+#include <cxxtools/jsondeserializer.h>
+
+#include "fty_info_classes.h"
+
+//  Fields taken from "release-details" object
+typedef enum {
+    FIELD_UUID = 0,
+    FIELD_VENDOR,
+    FIELD_SERIAL,
+    FIELD_CATALOG_NUMBER,
+    FIELD_PART_NUMBER,
+    FIELD_OSIMAGE_NAME,
+    FIELD_COUNT
+} releasedetails_field_t;
+
+static const char *s_keys [FIELD_COUNT] = {
+    "uuid",
+    "hardware-vendor",
+    "hardware-serial-number",
+    "hardware-catalog-number",
+    "hardware-part-number",
+    "osimage-name"
+};
+
+//  Structure of our class
+
+struct _releasedetails_t {
+    std::string path;
+    std::string values [FIELD_COUNT];
+    bool present [FIELD_COUNT];
+    bool loaded;                // file identity below is valid
+    bool missing;               // file could not be found by last refresh
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    size_t loads;
+};
+
+
+//  --------------------------------------------------------------------------
+//  Create a new releasedetails
+
+releasedetails_t *
+releasedetails_new (const char *path)
+{
+    releasedetails_t *self = new releasedetails_t;
+    assert (self);
+    self->path.assign (path ? path : DEFAULT_RELEASE_DETAILS);
+    for (int i = 0; i < FIELD_COUNT; i++)
+        self->present [i] = false;
+    self->loaded = false;
+    self->missing = false;
+    self->dev = 0;
+    self->ino = 0;
+    self->size = 0;
+    self->mtime.tv_sec = 0;
+    self->mtime.tv_nsec = 0;
+    self->loads = 0;
+    return self;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Destroy the releasedetails
+
+void
+releasedetails_destroy (releasedetails_t **self_p)
+{
+    assert (self_p);
+    if (*self_p) {
+        releasedetails_t *self = *self_p;
+        delete self;
+        *self_p = NULL;
+    }
+}
+
+
+//  --------------------------------------------------------------------------
+//  Change path of the file
+
+void
+releasedetails_set_path (releasedetails_t *self, const char *path)
+{
+    assert (self);
+    assert (path);
+    self->path.assign (path);
+    // state of previous file says nothing about the new one
+    self->loaded = false;
+    self->missing = false;
+    self->dev = 0;
+    self->ino = 0;
+    self->size = 0;
+    self->mtime.tv_sec = 0;
+    self->mtime.tv_nsec = 0;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Return path of the file
+
+const char *
+releasedetails_path (releasedetails_t *self)
+{
+    assert (self);
+    return self->path.c_str ();
+}
+
+
+//  --------------------------------------------------------------------------
+//  Mark all fields absent
+
+static void
+s_clear (releasedetails_t *self)
+{
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        self->present [i] = false;
+        self->values [i].clear ();
+    }
+}
+
+
+//  --------------------------------------------------------------------------
+//  Parse the file into fields, missing member leaves field absent
+
+static void
+s_parse (releasedetails_t *self)
+{
+    s_clear (self);
+    self->loads++;
+
+    cxxtools::SerializationInfo si;
+    try {
+        std::ifstream f (self->path);
+        cxxtools::JsonDeserializer json (f);
+        json.deserialize (si);
+        log_info ("fty-info:load %s OK", self->path.c_str ());
+    }
+    catch (const std::exception& e) {
+        log_error ("Error while parsing JSON %s: %s", self->path.c_str (), e.what ());
+        return;
+    }
+
+    const cxxtools::SerializationInfo *details = si.findMember ("release-details");
+    if (!details) {
+        log_info ("Problem with getting release-details in JSON %s", self->path.c_str ());
+        return;
+    }
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        const cxxtools::SerializationInfo *member = details->findMember (s_keys [i]);
+        if (!member)
+            continue;
+        try {
+            *member >>= self->values [i];
+            self->present [i] = true;
+        }
+        catch (const std::exception& e) {
+            log_info ("Problem with getting %s in JSON: %s", s_keys [i], e.what ());
+        }
+    }
+}
+
+
+//  --------------------------------------------------------------------------
+//  Parse the file if it changed since last parse
+
+bool
+releasedetails_refresh (releasedetails_t *self)
+{
+    assert (self);
+    struct stat st;
+    if (stat (self->path.c_str (), &st) == -1) {
+        if (self->missing)
+            return false;
+        log_error ("Cannot stat %s: %s", self->path.c_str (), strerror (errno));
+        self->missing = true;
+        self->loaded = false;
+        s_clear (self);
+        return true;
+    }
+    self->missing = false;
+    if (self->loaded
+    &&  self->dev == st.st_dev && self->ino == st.st_ino && self->size == st.st_size
+    &&  self->mtime.tv_sec == st.st_mtim.tv_sec && self->mtime.tv_nsec == st.st_mtim.tv_nsec)
+        return false;
+
+    self->loaded = true;
+    self->dev = st.st_dev;
+    self->ino = st.st_ino;
+    self->size = st.st_size;
+    self->mtime = st.st_mtim;
+    s_parse (self);
+    return true;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Getters of fields
+
+static const char *
+s_value (releasedetails_t *self, releasedetails_field_t field)
+{
+    assert (self);
+    return self->present [field] ? self->values [field].c_str () : NULL;
+}
+
+const char *
+releasedetails_uuid (releasedetails_t *self)
+{
+    return s_value (self, FIELD_UUID);
+}
+
+const char *
+releasedetails_vendor (releasedetails_t *self)
+{
+    return s_value (self, FIELD_VENDOR);
+}
+
+const char *
+releasedetails_serial (releasedetails_t *self)
+{
+    return s_value (self, FIELD_SERIAL);
+}
+
+const char *
+releasedetails_catalog_number (releasedetails_t *self)
+{
+    return s_value (self, FIELD_CATALOG_NUMBER);
+}
+
+const char *
+releasedetails_part_number (releasedetails_t *self)
+{
+    return s_value (self, FIELD_PART_NUMBER);
+}
+
+const char *
+releasedetails_osimage_name (releasedetails_t *self)
+{
+    return s_value (self, FIELD_OSIMAGE_NAME);
+}
+
+
+//  --------------------------------------------------------------------------
+//  Return how many times the file was parsed
+
+size_t
+releasedetails_loads (releasedetails_t *self)
+{
+    assert (self);
+    return self->loads;
+}
+
+
+//  --------------------------------------------------------------------------
+//  Self test of this class
+
+void
+releasedetails_test (bool verbose)
+{
+    printf (" * releasedetails: ");
+
+    //  @selftest
+    const char *SELFTEST_DIR_RO = "src/selftest-ro";
+    const char *SELFTEST_DIR_RW = "src/selftest-rw";
+    assert (SELFTEST_DIR_RO);
+    assert (SELFTEST_DIR_RW);
+    char *fixture = zsys_sprintf ("%s/data/release-details.json", SELFTEST_DIR_RO);
+    char *path = zsys_sprintf ("%s/release-details.json", SELFTEST_DIR_RW);
+    zsys_dir_create (SELFTEST_DIR_RW);
+
+    releasedetails_t *self = releasedetails_new (fixture);
+    assert (self);
+    assert (streq (releasedetails_path (self), fixture));
+    assert (releasedetails_uuid (self) == NULL);
+
+    assert (releasedetails_refresh (self));
+    assert (streq (releasedetails_uuid (self), "ce7c523e-08bf-11e7-af17-080027d52c4f"));
+    assert (streq (releasedetails_vendor (self), "Eaton"));
+    assert (streq (releasedetails_serial (self), "LA71026006"));
+    assert (streq (releasedetails_catalog_number (self), "IPC3000"));
+    assert (streq (releasedetails_part_number (self), "123456"));
+    assert (streq (releasedetails_osimage_name (self), "1.0.0"));
+
+    // unchanged file is not parsed again
+    assert (!releasedetails_refresh (self));
+    assert (releasedetails_loads (self) == 1);
+
+    // replaced file (new inode) is parsed again
+    releasedetails_set_path (self, path);
+    unlink (path);
+    FILE *f = fopen (path, "w");
+    assert (f);
+    fprintf (f, "{ \"release-details\": { \"uuid\": \"first\" } }\n");
+    fclose (f);
+    assert (releasedetails_refresh (self));
+    assert (streq (releasedetails_uuid (self), "first"));
+    assert (releasedetails_vendor (self) == NULL);
+
+    char *tmp = zsys_sprintf ("%s.new", path);
+    f = fopen (tmp, "w");
+    assert (f);
+    fprintf (f, "{ \"release-details\": { \"uuid\": \"second\" } }\n");
+    fclose (f);
+    assert (rename (tmp, path) == 0);
+    assert (releasedetails_refresh (self));
+    assert (streq (releasedetails_uuid (self), "second"));
+    assert (releasedetails_loads (self) == 3);
+
+    // removed file clears fields once
+    unlink (path);
+    assert (releasedetails_refresh (self));
+    assert (releasedetails_uuid (self) == NULL);
+    assert (!releasedetails_refresh (self));
+
+    zstr_free (&tmp);
+    releasedetails_destroy (&self);
+    assert (self == NULL);
+
+    // missing file
+    self = releasedetails_new ("/nonexistent/release-details.json");
+    assert (releasedetails_refresh (self));
+    assert (releasedetails_uuid (self) == NULL);
+    assert (!releasedetails_refresh (self));
+    // another path is checked afresh, whether it is missing or not
+    releasedetails_set_path (self, "/nonexistent/other.json");
+    assert (releasedetails_refresh (self));
+    releasedetails_set_path (self, fixture);
+    assert (releasedetails_refresh (self));
+    assert (streq (releasedetails_uuid (self), "ce7c523e-08bf-11e7-af17-080027d52c4f"));
+    releasedetails_destroy (&self);
+
+    zstr_free (&path);
+    zstr_free (&fixture);
+    //  @end
+    printf ("OK\n");
+}
@@ -0,0 +1,88 @@
+/*  =========================================================================
+    releasedetails - Cache of parsed release details
+
+    Copyright (C) 2014 - 2018 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#ifndef RELEASEDETAILS_H_INCLUDED
+#define RELEASEDETAILS_H_INCLUDED
+
+#define DEFAULT_RELEASE_DETAILS "/etc/release-details.json"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  @interface
+//  Create a new releasedetails for file path, NULL means the default
+//  DEFAULT_RELEASE_DETAILS. File is read by the first refresh.
+FTY_INFO_PRIVATE releasedetails_t *
+    releasedetails_new (const char *path);
+
+//  Destroy the releasedetails
+FTY_INFO_PRIVATE void
+    releasedetails_destroy (releasedetails_t **self_p);
+
+//  Change path of the file, it is read by the next refresh
+FTY_INFO_PRIVATE void
+    releasedetails_set_path (releasedetails_t *self, const char *path);
+
+//  Return path of the file
+FTY_INFO_PRIVATE const char *
+    releasedetails_path (releasedetails_t *self);
+
+//  Parse the file if it was not parsed yet or if its inode, size or
+//  modification time changed since.
+//  Return true if fields were (re)loaded
+FTY_INFO_PRIVATE bool
+    releasedetails_refresh (releasedetails_t *self);
+
+//  Getters of fields, NULL if the field is missing
+FTY_INFO_PRIVATE const char *
+    releasedetails_uuid (releasedetails_t *self);
+
+FTY_INFO_PRIVATE const char *
+    releasedetails_vendor (releasedetails_t *self);
+
+FTY_INFO_PRIVATE const char *
+    releasedetails_serial (releasedetails_t *self);
+
+FTY_INFO_PRIVATE const char *
+    releasedetails_catalog_number (releasedetails_t *self);
+
+FTY_INFO_PRIVATE const char *
+    releasedetails_part_number (releasedetails_t *self);
+
+FTY_INFO_PRIVATE const char *
+    releasedetails_osimage_name (releasedetails_t *self);
+
+//  Return how many times the file was parsed
+FTY_INFO_PRIVATE size_t
+    releasedetails_loads (releasedetails_t *self);
+
+//  Self test of this class
+FTY_INFO_PRIVATE void
+    releasedetails_test (bool verbose);
+
+//  @end
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -23,12 +23,22 @@
 @header
     topologyresolver - Class for asset location recursive resolving
 @discuss
+    Missing parents are requested from asset agent by ASSET_DETAIL and the
+    resolver never waits for the reply. Outstanding requests are kept in a
+    table keyed by correlation id; the owner polls msgpipe and calls recv
+    for replies, and calls expire when timeout elapses, which resends the
+    request with doubled timeout or gives it up. When a reply changes the
+    resolved data or a request is given up, the version changes and the
+    callback is called so the owner can re-evaluate the topology.
+
+    Assets are cached as compact records holding only the fields resolver
+    uses, every record is one allocation with its strings. While
+    discovering, every asset is a possible parent, so the cache is bounded
+    and the least recently stored assets out of the chain are evicted.
 @end
 */
 
 #include "fty_info_classes.h"
-#include <map>
-#include <set>
 
 // State
 #define DEFAULT_ENDPOINT "ipc://@/malamute"
@@ -38,61 +48,122 @@ typedef enum {
     UPTODATE
 } ResolverState;
 
+// ASSET_DETAIL request is resent with doubled timeout when no reply comes,
+// and given up after this many attempts
+#define RESOLVER_REQUEST_TIMEOUT_MS 2000
+#define RESOLVER_REQUEST_ATTEMPTS 4
+
+//  Outstanding ASSET_DETAIL request
+typedef struct {
+    char *iname;
+    int attempts;           // number of sends so far
+    int64_t deadline;       // zclock_mono () of resend or giving up
+} pending_request_t;
+
+//  Projection of asset message to fields used by resolver, allocated as
+//  one block together with its strings
+typedef struct {
+    void *handle;           // position in LRU list
+    size_t size;            // bytes allocated
+    const char *iname;
+    const char *name;       // ext fields, NULL if missing
+    const char *description;
+    const char *contact;
+    size_t parents_size;
+    const char **parents;   // parent_name.1, parent_name.2, ...
+} asset_record_t;
+
 //  Structure of our class
 
 struct _topologyresolver_t {
     char *iname;
-    char *topology;
     const char * endpoint;
     ResolverState state;
-    zhashx_t *assets;
+    zhashx_t *assets;       // asset_record_t by iname
+    zlistx_t *lru;          // asset_record_t, least recently stored first
+    size_t cache_max;       // bound of cached assets
+    size_t cache_bytes;     // bytes allocated by records
     mlm_client_t *client;
+    uint64_t version;       // incremented on every change of resolved data
+    localaddrs_t *localaddrs;   // not owned, NULL means enumerate when needed
+    zhashx_t *pending;      // pending_request_t by correlation id
+    topologyresolver_fn *callback;
+    void *callback_arg;
+
+    // resolved data, computed on demand and kept until an asset of the
+    // chain changes
+    bool resolved;          // following fields are valid
+    zlistx_t *parents;      // inames of all parents, including missing
+    zlistx_t *chain;        // inames from DC to parent, empty if incomplete
+    char *parent_uri;
+    char *name;
+    char *description;
+    char *contact;
+    char *topology;         // chain as friendly names joined by separator
+    char *separator;        // separator of topology
 };
 
-static std::map<std::string,std::set<std::string>>
-s_local_addresses()
+static void
+s_pending_request_destroy (pending_request_t **self_p)
 {
-    struct ifaddrs *interfaces, *iface;
-    char host[NI_MAXHOST];
-    std::map<std::string,std::set<std::string>> result;
+    if (*self_p) {
+        zstr_free (&(*self_p)->iname);
+        free (*self_p);
+        *self_p = NULL;
+    }
+}
+
+//  Send (or resend) request and set its deadline
+static void
+s_send_request (topologyresolver_t *self, const char *uuid, pending_request_t *request, int64_t now)
+{
+    log_debug ("ask ASSET AGENT for ASSET_DETAIL, RC = %s, iname = %s, attempt %d",
+            self->iname, request->iname, request->attempts + 1);
+    mlm_client_sendtox (self->client, FTY_ASSET_AGENT, "ASSET_DETAIL",
+            "GET", uuid, request->iname, NULL);
+    request->deadline = now + ((int64_t) RESOLVER_REQUEST_TIMEOUT_MS << request->attempts);
+    request->attempts++;
+}
 
-    if (getifaddrs (&interfaces) == -1) {
-        return result;
+//  Ask asset agent for asset, unless it is asked already
+static void
+s_request_asset (topologyresolver_t *self, const char *iname)
+{
+    if (!mlm_client_connected (self->client))
+        return;
+    pending_request_t *request = (pending_request_t *) zhashx_first (self->pending);
+    while (request) {
+        if (streq (request->iname, iname))
+            return;
+        request = (pending_request_t *) zhashx_next (self->pending);
     }
-    iface = interfaces;
-    for (iface = interfaces; iface != NULL; iface = iface->ifa_next) {
-        if (iface->ifa_addr == NULL) continue;
-        int family = iface->ifa_addr->sa_family;
-        if (family == AF_INET || family == AF_INET6) {
-            if (
-                    getnameinfo(iface->ifa_addr,
-                        (family == AF_INET) ? sizeof(struct sockaddr_in) :
-                        sizeof(struct sockaddr_in6),
-                        host, NI_MAXHOST,
-                        NULL, 0, NI_NUMERICHOST) == 0
-               ) {
-                // sometimes IPv6 addres looks like ::2342%IfaceName
-                char *p = strchr (host, '%');
-                if (p) *p = 0;
-
-                auto it = result.find (iface->ifa_name);
-                if (it == result.end()) {
-                    std::set<std::string> aSet;
-                    aSet.insert (host);
-                    result [iface->ifa_name] = aSet;
-                } else {
-                    result [iface->ifa_name].insert (host);
-                }
-            }
-        }
+    request = (pending_request_t *) zmalloc (sizeof (pending_request_t));
+    assert (request);
+    request->iname = strdup (iname);
+    zuuid_t *uuid = zuuid_new ();
+    zhashx_insert (self->pending, zuuid_str_canonical (uuid), request);
+    s_send_request (self, zuuid_str_canonical (uuid), request, zclock_mono ());
+    zuuid_destroy (&uuid);
+}
+
+//  Return true if any of ext keys prefix.1, prefix.2, ... is a local address
+static bool
+s_has_local_address (localaddrs_t *addrs, zhash_t *ext, const char *prefix)
+{
+    char key [32];
+    for (int index = 1; ; index++) {
+        snprintf (key, sizeof (key), "%s.%d", prefix, index);
+        const char *ip = (const char *) zhash_lookup (ext, key);
+        if (!ip)
+            return false;
+        if (localaddrs_contains (addrs, ip))
+            return true;
     }
-    freeifaddrs (interfaces);
-    return result;
 }
 
 //check if this is our rack controller - is any IP address
 //of this asset the same as one of the local addresses?
-static bool s_is_this_me (fty_proto_t *asset)
+static bool s_is_this_me (topologyresolver_t *self, fty_proto_t *asset)
 {
     const char *operation = fty_proto_operation (asset);
     bool found = false;
@@ -102,55 +173,196 @@ static bool s_is_this_me (fty_proto_t *asset)
         const char *type = fty_proto_aux_string (asset, "type", "");
         const char *subtype = fty_proto_aux_string (asset, "subtype", "");
         if (streq (type, "device") && streq (subtype, "rackcontroller")) {
-            auto ifaces = s_local_addresses ();
+            localaddrs_t *own_addrs = NULL;
+            localaddrs_t *addrs = self->localaddrs;
+            if (!addrs)
+                own_addrs = addrs = localaddrs_new (false);
             zhash_t *ext = fty_proto_ext (asset);
+            found = s_has_local_address (addrs, ext, "ipv6")
+                 || s_has_local_address (addrs, ext, "ip");
+            localaddrs_destroy (&own_addrs);
+        }
+    }
+    return found;
+}
 
-            int ipv6_index = 1;
-            found = false;
-            while (true) {
-                void *ip = zhash_lookup (ext, ("ipv6." + std::to_string (ipv6_index)).c_str ());
-                ipv6_index++;
-                if (ip != NULL) {
-                    for (auto &iface : ifaces) {
-                        if (iface.second.find ((char *)ip) != iface.second.end ()) {
-                            found = true;
-                            //try another network interface only if match was not found
-                            break;
-                        }
-                    }
-                    // try another address only if match was not found
-                    if (found)
-                        break;
-                }
-                // no other IPv6 address on the investigated asset
-                else
-                    break;
-            }
+//  --------------------------------------------------------------------------
+//  Create record of asset message
 
-            found = false;
-            int ipv4_index = 1;
-            while (true) {
-                void *ip = zhash_lookup (ext, ("ip." + std::to_string (ipv4_index)).c_str ());
-                ipv4_index++;
-                if (ip != NULL) {
-                    for (auto &iface : ifaces) {
-                        if (iface.second.find ((char *)ip) != iface.second.end ()) {
-                            found = true;
-                            //try another network interface only if match was not found
-                            break;
-                        }
-                    }
-                    // try another address only if match was not found
-                    if (found)
-                        break;
-                }
-                // no other IPv4 address on the investigated asset
-                else
-                    break;
-            }
+static asset_record_t *
+s_asset_record_new (const char *iname, fty_proto_t *msg)
+{
+    const char *fields [3] = {
+        fty_proto_ext_string (msg, "name", NULL),
+        fty_proto_ext_string (msg, "description", NULL),
+        fty_proto_ext_string (msg, "contact_email", NULL)
+    };
+    const char *parents [100];
+    size_t parents_size = 0;
+    char buffer[16]; // strlen ("parent_name.123") + 1
+    for (int i=1; i<100; i++) {
+        snprintf (buffer, 16, "parent_name.%i", i);
+        parents [parents_size] = fty_proto_aux_string (msg, buffer, NULL);
+        if (! parents [parents_size]) break;
+        parents_size++;
+    }
+
+    size_t size = sizeof (asset_record_t) + parents_size * sizeof (char *) + strlen (iname) + 1;
+    for (int i = 0; i < 3; i++)
+        size += fields [i] ? strlen (fields [i]) + 1 : 0;
+    for (size_t i = 0; i < parents_size; i++)
+        size += strlen (parents [i]) + 1;
+
+    asset_record_t *self = (asset_record_t *) zmalloc (size);
+    assert (self);
+    self->size = size;
+    self->parents_size = parents_size;
+    self->parents = (const char **) (self + 1);
+    char *data = (char *) (self->parents + parents_size);
+    const char **targets [4] = { &self->iname, &self->name, &self->description, &self->contact };
+    const char *values [4] = { iname, fields [0], fields [1], fields [2] };
+    for (int i = 0; i < 4; i++) {
+        if (!values [i])
+            continue;
+        *targets [i] = strcpy (data, values [i]);
+        data += strlen (values [i]) + 1;
+    }
+    for (size_t i = 0; i < parents_size; i++) {
+        self->parents [i] = strcpy (data, parents [i]);
+        data += strlen (parents [i]) + 1;
+    }
+    return self;
+}
+
+//  Return true if both records hold the same data
+static bool
+s_asset_record_eq (asset_record_t *self, asset_record_t *other)
+{
+    if (self->size != other->size || self->parents_size != other->parents_size)
+        return false;
+    const char *fields [4] = { self->iname, self->name, self->description, self->contact };
+    const char *others [4] = { other->iname, other->name, other->description, other->contact };
+    for (int i = 0; i < 4; i++) {
+        if (!fields [i] != !others [i] || (fields [i] && !streq (fields [i], others [i])))
+            return false;
+    }
+    for (size_t i = 0; i < self->parents_size; i++) {
+        if (!streq (self->parents [i], other->parents [i]))
+            return false;
+    }
+    return true;
+}
+
+static void
+s_asset_record_destroy (asset_record_t **self_p)
+{
+    free (*self_p);
+    *self_p = NULL;
+}
+
+//  Remove asset from cache
+static void
+s_cache_remove (topologyresolver_t *self, const char *iname)
+{
+    asset_record_t *record = (asset_record_t *) zhashx_lookup (self->assets, iname);
+    if (!record)
+        return;
+    zhashx_delete (self->assets, record->iname);
+    self->cache_bytes -= record->size;
+    zlistx_delete (self->lru, record->handle);
+}
+
+//  Store asset to cache, replacing its previous record. Return false if
+//  the previous record held the same data.
+static bool
+s_cache_store (topologyresolver_t *self, const char *iname, fty_proto_t *msg)
+{
+    asset_record_t *record = s_asset_record_new (iname, msg);
+    asset_record_t *previous = (asset_record_t *) zhashx_lookup (self->assets, iname);
+    bool changed = !previous || !s_asset_record_eq (previous, record);
+    s_cache_remove (self, iname);
+    zhashx_insert (self->assets, record->iname, record);
+    record->handle = zlistx_add_end (self->lru, record);
+    self->cache_bytes += record->size;
+    return changed;
+}
+
+static zlistx_t *
+s_iname_list_new (void)
+{
+    zlistx_t *list = zlistx_new();
+    zlistx_set_destructor (list, (void (*)(void**))zstr_free);
+    zlistx_set_duplicator (list, (void* (*)(const void*))strdup);
+    zlistx_set_comparator (list, (int (*)(const void *,const void *))strcmp);
+    return list;
+}
+
+//  Drop resolved data
+static void
+s_invalidate (topologyresolver_t *self)
+{
+    self->resolved = false;
+    zlistx_purge (self->parents);
+    zlistx_purge (self->chain);
+    zstr_free (&self->parent_uri);
+    zstr_free (&self->name);
+    zstr_free (&self->description);
+    zstr_free (&self->contact);
+    zstr_free (&self->topology);
+    zstr_free (&self->separator);
+}
+
+static char *
+s_strdup (const char *value)
+{
+    return value ? strdup (value) : NULL;
+}
+
+//  Compute resolved data unless they are valid. Missing parents are
+//  requested from asset agent, all of them at once, so that the chain is
+//  complete after one round trip.
+static void
+s_resolve (topologyresolver_t *self)
+{
+    if (self->resolved)
+        return;
+    self->resolved = true;
+    asset_record_t *record = self->iname ? (asset_record_t *) zhashx_lookup (self->assets, self->iname) : NULL;
+    if (!record)
+        return;
+
+    self->name = s_strdup (record->name);
+    self->description = s_strdup (record->description);
+    self->contact = s_strdup (record->contact);
+    if (record->parents_size)
+        self->parent_uri = zsys_sprintf ("/asset/%s", record->parents [0]);
+
+    bool complete = true;
+    for (size_t i = 0; i < record->parents_size; i++) {
+        const char *parent = record->parents [i];
+        zlistx_add_end (self->parents, (void *) parent);
+        if (! zhashx_lookup (self->assets, parent)) {
+            // ask ASSET_AGENT for ASSET_DETAIL, topology is not complete until it replies
+            s_request_asset (self, parent);
+            complete = false;
+        } else if (complete) {
+            zlistx_add_start (self->chain, (void *) parent);
         }
     }
-    return found;
+    if (! complete)
+        zlistx_purge (self->chain);
+}
+
+//  Asset in cache changed, drop resolved data if they depend on it
+static void
+s_asset_changed (topologyresolver_t *self, const char *iname)
+{
+    if (self->resolved
+    &&  !(self->iname && streq (self->iname, iname))
+    &&  !zlistx_find (self->parents, (void *) iname))
+        return;
+    s_invalidate (self);
+    self->version++;
 }
 
 static void
@@ -158,21 +370,50 @@ s_purge_message_cache (topologyresolver_t *self)
 {
     if (!self || !self->assets) return;
 
-    zlistx_t *topo = topologyresolver_to_list (self);
+    s_resolve (self);
     zlistx_t *inames = zhashx_keys (self->assets);
 
     const char *iname = (char *) zlistx_first (inames);
     while (iname) {
-        if (! zlistx_find (topo, (void *)iname) && ! streq (self->iname, iname)) {
+        if (! zlistx_find (self->chain, (void *)iname) && ! streq (self->iname, iname)) {
             // asset is not me neither parent
-            zhashx_delete (self->assets, iname);
+            s_cache_remove (self, iname);
         }
         iname = (char *) zlistx_next (inames);
     }
-    zlistx_destroy (&topo);
     zlistx_destroy (&inames);
 }
 
+//  Evict least recently stored assets over the bound; this RC and its
+//  parents are never evicted
+static void
+s_cache_evict (topologyresolver_t *self)
+{
+    if (zhashx_size (self->assets) <= self->cache_max)
+        return;
+    s_resolve (self);
+    asset_record_t *record = (asset_record_t *) zlistx_first (self->lru);
+    while (record && zhashx_size (self->assets) > self->cache_max) {
+        asset_record_t *next = (asset_record_t *) zlistx_next (self->lru);
+        if (! (self->iname && streq (self->iname, record->iname))
+        &&  ! zlistx_find (self->parents, (void *) record->iname)) {
+            log_trace ("evicting %s from asset cache", record->iname);
+            s_cache_remove (self, record->iname);
+        }
+        record = next;
+    }
+}
+
+//  Store asset to cache and drop what depends on it, unless the asset
+//  carries the same data as before (repeated UPDATE or ASSET_DETAIL reply)
+static void
+s_asset_update (topologyresolver_t *self, const char *iname, fty_proto_t *msg)
+{
+    if (s_cache_store (self, iname, msg))
+        s_asset_changed (self, iname);
+    s_cache_evict (self);
+}
+
 //  --------------------------------------------------------------------------
 //  Create a new topologyresolver
 
@@ -184,10 +425,16 @@ topologyresolver_new (const char *iname)
     //  Initialize class properties here
     if (iname) self->iname = strdup (iname);
     self->state = DISCOVERING;
+    // records are owned by lru list
     self->assets = zhashx_new ();
-    zhashx_set_destructor (self->assets, (czmq_destructor *) fty_proto_destroy);
-    zhashx_set_duplicator (self->assets, (czmq_duplicator *) fty_proto_dup);
+    self->lru = zlistx_new ();
+    zlistx_set_destructor (self->lru, (czmq_destructor *) s_asset_record_destroy);
+    self->cache_max = SIZE_MAX;
     self->client = mlm_client_new ();
+    self->pending = zhashx_new ();
+    zhashx_set_destructor (self->pending, (czmq_destructor *) s_pending_request_destroy);
+    self->parents = s_iname_list_new ();
+    self->chain = s_iname_list_new ();
     return self;
 }
 
@@ -203,8 +450,12 @@ topologyresolver_destroy (topologyresolver_t **self_p)
         topologyresolver_t *self = *self_p;
         //  Free class properties here
         zhashx_destroy (&self->assets);
+        zlistx_destroy (&self->lru);
+        zhashx_destroy (&self->pending);
+        s_invalidate (self);
+        zlistx_destroy (&self->parents);
+        zlistx_destroy (&self->chain);
         zstr_free (&self->iname);
-        zstr_free (&self->topology);
         mlm_client_destroy (&self->client);
         //  Free object itself
         free (self);
@@ -221,6 +472,162 @@ topologyresolver_set_endpoint (topologyresolver_t *self, const char *endpoint)
     mlm_client_connect (self->client, endpoint, 1000, "fty_info_topologyresolver");
 }
 
+//  --------------------------------------------------------------------------
+//  Set bound of cached assets
+
+void
+topologyresolver_set_cache_size (topologyresolver_t *self, size_t size)
+{
+    assert (self);
+    self->cache_max = size;
+    s_cache_evict (self);
+}
+
+//  --------------------------------------------------------------------------
+//  Return number of cached assets
+
+size_t
+topologyresolver_cache_size (topologyresolver_t *self)
+{
+    assert (self);
+    return zhashx_size (self->assets);
+}
+
+//  --------------------------------------------------------------------------
+//  Return bytes allocated by cached assets
+
+size_t
+topologyresolver_cache_bytes (topologyresolver_t *self)
+{
+    assert (self);
+    return self->cache_bytes;
+}
+
+//  --------------------------------------------------------------------------
+//  Set callback called when a reply of asset agent changed resolved data
+//  or a request was given up
+
+void
+topologyresolver_set_callback (topologyresolver_t *self, topologyresolver_fn *callback, void *arg)
+{
+    assert (self);
+    self->callback = callback;
+    self->callback_arg = arg;
+}
+
+//  --------------------------------------------------------------------------
+//  Return socket to poll for replies of asset agent
+
+zsock_t *
+topologyresolver_msgpipe (topologyresolver_t *self)
+{
+    assert (self);
+    return mlm_client_msgpipe (self->client);
+}
+
+//  --------------------------------------------------------------------------
+//  Process one reply of asset agent
+
+void
+topologyresolver_recv (topologyresolver_t *self)
+{
+    assert (self);
+    zmsg_t *reply = mlm_client_recv (self->client);
+    if (!reply)
+        return;
+    char *uuid = zmsg_popstr (reply);
+    pending_request_t *request = uuid ? (pending_request_t *) zhashx_lookup (self->pending, uuid) : NULL;
+    if (!request) {
+        // late reply of given up request, or something we did not ask for
+        log_debug ("ignoring unexpected message from %s", mlm_client_sender (self->client));
+        zstr_free (&uuid);
+        zmsg_destroy (&reply);
+        return;
+    }
+    if (!fty_proto_is (reply)) {
+        // unknown asset, topology is not complete; request stays pending,
+        // so it is retried after its timeout instead of immediately
+        log_warning ("%s has no ASSET_DETAIL of %s", FTY_ASSET_AGENT, request->iname);
+        zstr_free (&uuid);
+        zmsg_destroy (&reply);
+        return;
+    }
+
+    fty_proto_t *asset = fty_proto_decode (&reply);
+    if (asset) {
+        s_asset_update (self, request->iname, asset);
+        fty_proto_destroy (&asset);
+    }
+    zhashx_delete (self->pending, uuid);
+    zstr_free (&uuid);
+
+    // chain is complete once replies for all missing parents are in
+    s_resolve (self);
+    bool resolved = zlistx_size (self->chain) > 0;
+    if (!resolved && zhashx_size (self->pending))
+        return;
+    if (resolved && self->state == DISCOVERING) {
+        self->state = UPTODATE;
+        s_purge_message_cache (self);
+    }
+    if (self->callback)
+        self->callback (self, resolved, self->callback_arg);
+}
+
+//  --------------------------------------------------------------------------
+//  Return ms until the nearest request deadline, -1 if nothing is pending
+
+int
+topologyresolver_timeout (topologyresolver_t *self, int64_t now)
+{
+    assert (self);
+    int64_t deadline = -1;
+    pending_request_t *request = (pending_request_t *) zhashx_first (self->pending);
+    while (request) {
+        if (deadline == -1 || request->deadline < deadline)
+            deadline = request->deadline;
+        request = (pending_request_t *) zhashx_next (self->pending);
+    }
+    if (deadline == -1)
+        return -1;
+    return deadline > now ? (int) (deadline - now) : 0;
+}
+
+//  --------------------------------------------------------------------------
+//  Resend or give up requests whose deadline passed
+
+void
+topologyresolver_expire (topologyresolver_t *self, int64_t now)
+{
+    assert (self);
+    if (!zhashx_size (self->pending))
+        return;
+    bool given_up = false;
+    zlistx_t *uuids = zhashx_keys (self->pending);
+    const char *uuid = (const char *) zlistx_first (uuids);
+    while (uuid) {
+        pending_request_t *request = (pending_request_t *) zhashx_lookup (self->pending, uuid);
+        if (request->deadline <= now) {
+            if (request->attempts < RESOLVER_REQUEST_ATTEMPTS && mlm_client_connected (self->client))
+                s_send_request (self, uuid, request, now);
+            else {
+                log_warning ("no ASSET_DETAIL of %s after %d attempts, giving up", request->iname, request->attempts);
+                zhashx_delete (self->pending, uuid);
+                given_up = true;
+            }
+        }
+        uuid = (const char *) zlistx_next (uuids);
+    }
+    zlistx_destroy (&uuids);
+    if (!given_up)
+        return;
+    // owner sees new version, so its next query resolves and asks again
+    s_invalidate (self);
+    self->version++;
+    if (self->callback)
+        self->callback (self, false, self->callback_arg);
+}
+
 //  --------------------------------------------------------------------------
 //  get RC internal name
 
@@ -231,6 +638,26 @@ topologyresolver_id (topologyresolver_t *self)
     return strdup(self->iname);
 }
 
+//  --------------------------------------------------------------------------
+//  Return version of resolved data, it changes whenever data can change
+
+uint64_t
+topologyresolver_version (topologyresolver_t *self)
+{
+    assert (self);
+    return self->version;
+}
+
+//  --------------------------------------------------------------------------
+//  Set registry of local addresses used to recognize own asset
+
+void
+topologyresolver_set_localaddrs (topologyresolver_t *self, localaddrs_t *addrs)
+{
+    assert (self);
+    self->localaddrs = addrs;
+}
+
 //  --------------------------------------------------------------------------
 //  Give topology resolver one asset information
 bool
@@ -244,52 +671,47 @@ topologyresolver_asset (topologyresolver_t *self, fty_proto_t *message)
 
     const char *iname = fty_proto_name (message);
     // is this message about me?
-    if (!self->iname && s_is_this_me (message)) {
+    if (!self->iname && s_is_this_me (self, message)) {
         self->iname = strdup (fty_proto_name (message));
+        s_invalidate (self);
+        self->version++;
         // previous code wasn't doing republish at this point
         return false;
     }
     if (self->iname && streq (self->iname, iname)) {
         // we received a message about ourselves, trigger recomputation
-        zhashx_update (self->assets, iname, message);
-        zlistx_t *list = topologyresolver_to_list (self);
-        if (! zlistx_size (list)) {
+        s_asset_update (self, iname, message);
+        s_resolve (self);
+        if (! zlistx_size (self->chain)) {
             // Can't resolve topology any more
             self->state = DISCOVERING;
-            zlistx_destroy (&list);
             return false;
         }
-        zlistx_destroy (&list);
         return true;
     }
 
     // is this message about my parent?
     if (self->state == DISCOVERING) {
         // discovering - every asset (except me) is a possible parent
-        zhashx_update (self->assets, iname, message);
-        zlistx_t *list = topologyresolver_to_list (self);
-        if (zlistx_size (list)) {
+        s_asset_update (self, iname, message);
+        s_resolve (self);
+        if (zlistx_size (self->chain)) {
             self->state = UPTODATE;
             s_purge_message_cache (self);
-            zlistx_destroy (&list);
             return true;
         }
-        zlistx_destroy (&list);
         return false;
     } else {
         // up to date - check assets in cache
-        fty_proto_t *iname_msg = (fty_proto_t *) zhashx_lookup (self->assets, iname);
-        if (iname_msg) {
+        if (zhashx_lookup (self->assets, iname)) {
             // we received a message about asset in our topology, trigger recomputation
-            zhashx_update (self->assets, iname, message);
-            zlistx_t *list = topologyresolver_to_list (self);
-            if (! zlistx_size (list)) {
+            s_asset_update (self, iname, message);
+            s_resolve (self);
+            if (! zlistx_size (self->chain)) {
                 // Can't resolv topology any more
                 self->state = DISCOVERING;
-                zlistx_destroy (&list);
                 return false;
             }
-            zlistx_destroy (&list);
             return true;
         }
     }
@@ -297,6 +719,26 @@ topologyresolver_asset (topologyresolver_t *self, fty_proto_t *message)
     return false;
 }
 
+//  --------------------------------------------------------------------------
+//  Return false if asset message can't change anything, decided from its
+//  iname and operation (NULL if unknown) before the message is decoded
+
+bool
+topologyresolver_wants (topologyresolver_t *self, const char *iname, const char *operation)
+{
+    assert (self);
+    assert (iname);
+    if (operation && streq (operation, "inventory"))
+        return false;
+    if (!self->iname || streq (self->iname, iname))
+        return true;
+    // without own record, every asset might be a parent
+    if (!zhashx_lookup (self->assets, self->iname))
+        return true;
+    s_resolve (self);
+    return zlistx_find (self->parents, (void *) iname) != NULL;
+}
+
 //  --------------------------------------------------------------------------
 // Return URI of asset for this topologyresolver
 char *
@@ -313,16 +755,9 @@ char *
 char *
 topologyresolver_to_parent_uri (topologyresolver_t *self)
 {
-    if (self && self->iname) {
-        fty_proto_t *rc_message = (fty_proto_t *) zhashx_lookup (self->assets, self->iname);
-        if (rc_message) {
-            const char *parent_iname = fty_proto_aux_string (rc_message, "parent_name.1", NULL);
-            if (parent_iname) {
-                return zsys_sprintf ("/asset/%s", parent_iname);
-            }
-        }
-    }
-    return NULL;
+    if (!self) return NULL;
+    s_resolve (self);
+    return self->parent_uri ? strdup (self->parent_uri) : NULL;
 }
 
 
@@ -331,16 +766,9 @@ topologyresolver_to_parent_uri (topologyresolver_t *self)
 char *
 topologyresolver_to_rc_name (topologyresolver_t *self)
 {
-    if (self && self->iname) {
-        fty_proto_t *rc_message = (fty_proto_t *) zhashx_lookup (self->assets, self->iname);
-        if (rc_message) {
-            const char *name = fty_proto_ext_string (rc_message, "name", NULL);
-            if (name) {
-                return strdup(name);
-            }
-        }
-    }
-    return NULL;
+    if (!self) return NULL;
+    s_resolve (self);
+    return self->name ? strdup (self->name) : NULL;
 }
 
 //  --------------------------------------------------------------------------
@@ -348,16 +776,9 @@ topologyresolver_to_rc_name (topologyresolver_t *self)
 char *
 topologyresolver_to_description (topologyresolver_t *self)
 {
-    if (self && self->iname) {
-        fty_proto_t *rc_message = (fty_proto_t *) zhashx_lookup (self->assets, self->iname);
-        if (rc_message) {
-            const char *description = fty_proto_ext_string (rc_message, "description", NULL);
-            if (description) {
-                return strdup(description);
-            }
-        }
-    }
-    return NULL;
+    if (!self) return NULL;
+    s_resolve (self);
+    return self->description ? strdup (self->description) : NULL;
 }
 
 //  --------------------------------------------------------------------------
@@ -365,16 +786,9 @@ topologyresolver_to_description (topologyresolver_t *self)
 char *
 topologyresolver_to_contact (topologyresolver_t *self)
 {
-    if (self && self->iname) {
-        fty_proto_t *rc_message = (fty_proto_t *) zhashx_lookup (self->assets, self->iname);
-        if (rc_message) {
-            const char *contact_email = fty_proto_ext_string (rc_message, "contact_email", NULL);
-            if (contact_email) {
-                strdup(contact_email);
-            }
-        }
-    }
-    return NULL;
+    if (!self) return NULL;
+    s_resolve (self);
+    return self->contact ? strdup (self->contact) : NULL;
 }
 
 //  --------------------------------------------------------------------------
@@ -382,35 +796,44 @@ topologyresolver_to_contact (topologyresolver_t *self)
 char *
 topologyresolver_to_string (topologyresolver_t *self, const char *separator)
 {
-    zlistx_t *parents = topologyresolver_to_list (self);
-
-    if (! zlistx_size (parents)) {
-        zlistx_destroy (&parents);
+    if (!self) return NULL;
+    s_resolve (self);
+    if (! zlistx_size (self->chain))
         return NULL;
-    }
+    if (self->topology && streq (self->separator, separator))
+        return strdup (self->topology);
 
+    // measure first, then copy names in one pass
+    size_t separator_size = strlen (separator);
+    size_t size = 0;
+    const char *iname = (const char *) zlistx_first (self->chain);
+    while (iname) {
+        asset_record_t *record = (asset_record_t *) zhashx_lookup (self->assets, iname);
+        size += (record->name ? strlen (record->name) : 0) + separator_size;
+        iname = (const char *) zlistx_next (self->chain);
+    }
     zstr_free (&self->topology);
-    self->topology = strdup ("");
-    char *iname = (char *) zlistx_first (parents);
+    zstr_free (&self->separator);
+    self->topology = (char *) zmalloc (size + 1);
+    char *end = self->topology;
+    bool first = true;
+    iname = (const char *) zlistx_first (self->chain);
     while (iname) {
-        fty_proto_t *msg = (fty_proto_t *) zhashx_lookup (self->assets, iname);
-        if (msg) {
-            const char *ename = fty_proto_ext_string (msg, "name", ""/*iname*/);
-            char *tmp = zsys_sprintf ("%s%s%s", self->topology, ename, separator);
-            if (tmp) {
-                zstr_free (&self->topology);
-                self->topology = tmp;
-            }
+        asset_record_t *record = (asset_record_t *) zhashx_lookup (self->assets, iname);
+        const char *ename = record->name ? record->name : ""/*iname*/;
+        if (!first) {
+            memcpy (end, separator, separator_size);
+            end += separator_size;
         }
-        iname = (char *) zlistx_next (parents);
-    };
-    if (strlen (self->topology) >= strlen (separator)) {
-        // remove trailing separator
-        char *p = &self->topology [strlen (self->topology) - strlen (separator)];
-        *p = 0;
+        size_t ename_size = strlen (ename);
+        memcpy (end, ename, ename_size);
+        end += ename_size;
+        first = false;
+        iname = (const char *) zlistx_next (self->chain);
     }
-    zlistx_destroy (&parents);
-    return strdup(self->topology);
+    *end = 0;
+    self->separator = strdup (separator);
+    return strdup (self->topology);
 }
 
 
@@ -420,61 +843,15 @@ topologyresolver_to_string (topologyresolver_t *self, const char *separator)
 zlistx_t *
 topologyresolver_to_list (topologyresolver_t *self)
 {
-    zlistx_t *list = zlistx_new();
-    zlistx_set_destructor (list, (void (*)(void**))zstr_free);
-    zlistx_set_duplicator (list, (void* (*)(const void*))strdup);
-    zlistx_set_comparator (list, (int (*)(const void *,const void *))strcmp);
-
-    if (!self || !self->iname) return list;
-    fty_proto_t *msg = (fty_proto_t *) zhashx_lookup (self->assets, self->iname);
-    if (!msg)
-        return list;
-
-    char buffer[16]; // strlen ("parent_name.123") + 1
+    if (!self) return s_iname_list_new ();
+    s_resolve (self);
+    return zlistx_dup (self->chain);
+}
 
-    for (int i=1; i<100; i++) {
-        snprintf (buffer, 16, "parent_name.%i", i);
-        const char *parent = fty_proto_aux_string (msg, buffer, NULL);
-        if (! parent) break;
-        if (! zhashx_lookup (self->assets, parent)) {
-            // ask ASSET_AGENT for ASSET_DETAIL
-            if (mlm_client_connected (self->client)) {
-                zuuid_t *uuid = zuuid_new ();
-                log_debug ("ask ASSET AGENT for ASSET_DETAIL, RC = %s, iname = %s", self->iname, parent);
-                mlm_client_sendtox (self->client, FTY_ASSET_AGENT, "ASSET_DETAIL",
-                        "GET", zuuid_str_canonical (uuid), parent, NULL);
-                zmsg_t *parent_msg = mlm_client_recv (self->client);
-                if (parent_msg) {
-                    char *rcv_uuid = zmsg_popstr (parent_msg);
-                    if (0 == strcmp (rcv_uuid, zuuid_str_canonical (uuid)) && fty_proto_is (parent_msg)) {
-                        fty_proto_t *parent_fmsg = fty_proto_decode (&parent_msg);
-                        zhashx_update (self->assets, parent, parent_fmsg);
-                        zlistx_add_start (list, (void *)parent);
-                    }
-                    else {
-                        // invalid zuuid or unknown parent, topology is not complete
-                        zlistx_purge (list);
-                        break;
-                    }
-                    zstr_free(&rcv_uuid);
-                }
-                else {
-                    // parent is unknown, topology is not complete
-                    zlistx_purge (list);
-                    break;
-                }
-                zuuid_destroy (&uuid);
-            }
-            else {
-                // parent is unknown, topology is not complete
-                zlistx_purge (list);
-                break;
-            }
-        } else {
-            zlistx_add_start (list, (void *)parent);
-        }
-    }
-    return list;
+static void
+s_test_callback (topologyresolver_t *self, bool resolved, void *arg)
+{
+    *(int *) arg = resolved ? 1 : -1;
 }
 
 void
@@ -551,6 +928,7 @@ topologyresolver_test (bool verbose)
     ext = zhash_new ();
     zhash_autofree (ext);
     zhash_update (ext, "name", (void *)"this is me");
+    zhash_update (ext, "contact_email", (void *)"me@example.com");
     fty_proto_set_ext (msg4, &ext);
     aux = zhash_new ();
     zhash_autofree (aux);
@@ -580,6 +958,43 @@ topologyresolver_test (bool verbose)
     res = topologyresolver_to_string (resolver, "->");
     assert (streq ("my nice grandparent->this is new father", res));
     free(res);
+    res = topologyresolver_to_string (resolver);
+    assert (streq ("my nice grandparent/this is new father", res));
+    free(res);
+    res = topologyresolver_to_contact (resolver);
+    assert (streq ("me@example.com", res));
+    free(res);
+
+    // asset out of the chain does not change resolved data
+    uint64_t version = topologyresolver_version (resolver);
+    assert (!topologyresolver_asset (resolver, msg1));
+    assert (topologyresolver_version (resolver) == version);
+    // neither does repeated parent with the same data
+    assert (topologyresolver_asset (resolver, msg5));
+    assert (topologyresolver_version (resolver) == version);
+    assert (!topologyresolver_wants (resolver, "bogus", NULL));
+    assert (topologyresolver_wants (resolver, "newparent", FTY_PROTO_ASSET_OP_UPDATE));
+    assert (!topologyresolver_wants (resolver, "me", "inventory"));
+    topologyresolver_destroy (&resolver);
+
+    // cache is bounded, this RC and its parents are not evicted
+    resolver = topologyresolver_new ("me");
+    topologyresolver_set_cache_size (resolver, 3);
+    assert (topologyresolver_cache_bytes (resolver) == 0);
+    assert (topologyresolver_wants (resolver, "bogus", NULL));
+    topologyresolver_asset (resolver, msg2);
+    topologyresolver_asset (resolver, msg);
+    for (int i = 0; i < 10; i++) {
+        fty_proto_set_name (msg1, "bogus-%d", i);
+        topologyresolver_asset (resolver, msg1);
+        assert (topologyresolver_cache_size (resolver) <= 3);
+    }
+    assert (topologyresolver_cache_bytes (resolver) > 0);
+    topologyresolver_asset (resolver, msg3);
+    res = topologyresolver_to_string (resolver, "->");
+    assert (streq ("my nice grandparent->this is father", res));
+    free(res);
+    assert (topologyresolver_cache_size (resolver) == 3);
 
     fty_proto_destroy (&msg5);
     fty_proto_destroy (&msg4);
@@ -589,5 +1004,112 @@ topologyresolver_test (bool verbose)
     fty_proto_destroy (&msg);
 
     topologyresolver_destroy (&resolver);
+
+    // missing parents are requested at once, without waiting for replies
+    static const char *endpoint = "inproc://topologyresolver-test";
+    zactor_t *server = zactor_new (mlm_server, (void *) "Malamute");
+    zstr_sendx (server, "BIND", endpoint, NULL);
+    mlm_client_t *agent = mlm_client_new ();
+    mlm_client_connect (agent, endpoint, 1000, FTY_ASSET_AGENT);
+
+    int resolved = 0;
+    resolver = topologyresolver_new ("me");
+    topologyresolver_set_endpoint (resolver, endpoint);
+    topologyresolver_set_callback (resolver, s_test_callback, &resolved);
+    assert (topologyresolver_timeout (resolver, zclock_mono ()) == -1);
+
+    msg2 = fty_proto_new (FTY_PROTO_ASSET);
+    fty_proto_set_name (msg2, "me");
+    fty_proto_set_operation (msg2, FTY_PROTO_ASSET_OP_CREATE);
+    aux = zhash_new ();
+    zhash_autofree (aux);
+    zhash_update (aux, "parent_name.1", (void *)"parent");
+    zhash_update (aux, "parent_name.2", (void *)"grandparent");
+    fty_proto_set_aux (msg2, &aux);
+    assert (!topologyresolver_asset (resolver, msg2));
+    fty_proto_destroy (&msg2);
+    assert (topologyresolver_timeout (resolver, zclock_mono ()) > 0);
+
+    const char *names [] = { "parent", "grandparent" };
+    const char *friendly [] = { "this is father", "my nice grandparent" };
+    char *uuids [2];
+    for (int i = 0; i < 2; i++) {
+        zmsg_t *request = mlm_client_recv (agent);
+        assert (streq (mlm_client_subject (agent), "ASSET_DETAIL"));
+        char *command = zmsg_popstr (request);
+        uuids [i] = zmsg_popstr (request);
+        char *iname = zmsg_popstr (request);
+        assert (streq (command, "GET"));
+        assert (streq (iname, names [i]));
+        zstr_free (&iname);
+        zstr_free (&command);
+        zmsg_destroy (&request);
+    }
+
+    // nobody answers, the same requests are resent after timeout
+    topologyresolver_expire (resolver, zclock_mono () + RESOLVER_REQUEST_TIMEOUT_MS);
+    for (int i = 0; i < 2; i++) {
+        zmsg_t *request = mlm_client_recv (agent);
+        zmsg_destroy (&request);
+    }
+
+    // agent answers the second attempts, chain is complete with the last reply
+    zmq_pollitem_t item = { zsock_resolve (topologyresolver_msgpipe (resolver)), 0, ZMQ_POLLIN, 0 };
+    for (int i = 1; i >= 0; i--) {
+        fty_proto_t *parent = fty_proto_new (FTY_PROTO_ASSET);
+        fty_proto_set_name (parent, "%s", names [i]);
+        fty_proto_set_operation (parent, FTY_PROTO_ASSET_OP_CREATE);
+        ext = zhash_new ();
+        zhash_autofree (ext);
+        zhash_update (ext, "name", (void *) friendly [i]);
+        fty_proto_set_ext (parent, &ext);
+        zmsg_t *reply = fty_proto_encode (&parent);
+        zmsg_pushstr (reply, uuids [i]);
+        mlm_client_sendto (agent, mlm_client_sender (agent), "ASSET_DETAIL", NULL, 1000, &reply);
+        zstr_free (&uuids [i]);
+
+        assert (zmq_poll (&item, 1, 1000) == 1);
+        topologyresolver_recv (resolver);
+        assert (resolved == (i ? 0 : 1));
+    }
+    assert (topologyresolver_timeout (resolver, zclock_mono ()) == -1);
+    res = topologyresolver_to_string (resolver, "->");
+    assert (streq ("my nice grandparent->this is father", res));
+    free (res);
+
+    topologyresolver_destroy (&resolver);
+
+    // unanswered request is given up, which the owner learns by version
+    resolved = 0;
+    resolver = topologyresolver_new ("me");
+    topologyresolver_set_endpoint (resolver, endpoint);
+    topologyresolver_set_callback (resolver, s_test_callback, &resolved);
+    msg2 = fty_proto_new (FTY_PROTO_ASSET);
+    fty_proto_set_name (msg2, "me");
+    fty_proto_set_operation (msg2, FTY_PROTO_ASSET_OP_CREATE);
+    aux = zhash_new ();
+    zhash_autofree (aux);
+    zhash_update (aux, "parent_name.1", (void *)"parent");
+    fty_proto_set_aux (msg2, &aux);
+    topologyresolver_asset (resolver, msg2);
+    fty_proto_destroy (&msg2);
+    version = topologyresolver_version (resolver);
+    int64_t now = zclock_mono ();
+    for (int i = 0; i < RESOLVER_REQUEST_ATTEMPTS; i++) {
+        assert (topologyresolver_timeout (resolver, now) >= 0);
+        now += 1000000;
+        topologyresolver_expire (resolver, now);
+    }
+    assert (topologyresolver_timeout (resolver, now) == -1);
+    assert (topologyresolver_version (resolver) != version);
+    assert (resolved == -1);
+    // next query asks again
+    res = topologyresolver_to_string (resolver);
+    free (res);
+    assert (topologyresolver_timeout (resolver, now) >= 0);
+    topologyresolver_destroy (&resolver);
+
+    mlm_client_destroy (&agent);
+    zactor_destroy (&server);
     printf ("OK\n");
 }
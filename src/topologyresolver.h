@@ -27,6 +27,10 @@ extern "C" {
 #endif
 
 //  @interface
+//  Callback called when a reply of asset agent changed resolved data or a
+//  request was given up, resolved is true if the topology is complete
+typedef void (topologyresolver_fn) (topologyresolver_t *self, bool resolved, void *arg);
+
 //  Create a new topologyresolver
 FTY_INFO_PRIVATE topologyresolver_t *
     topologyresolver_new (const char *iname);
@@ -39,6 +43,40 @@ FTY_INFO_PRIVATE void
 FTY_INFO_PRIVATE void
     topologyresolver_set_endpoint (topologyresolver_t *self, const char *endpoint);
 
+//  Set bound of cached assets, least recently stored assets out of the
+//  chain of this RC are evicted above it. Unbounded by default.
+FTY_INFO_PRIVATE void
+    topologyresolver_set_cache_size (topologyresolver_t *self, size_t size);
+
+//  Return number of cached assets
+FTY_INFO_PRIVATE size_t
+    topologyresolver_cache_size (topologyresolver_t *self);
+
+//  Return bytes allocated by records of cached assets
+FTY_INFO_PRIVATE size_t
+    topologyresolver_cache_bytes (topologyresolver_t *self);
+
+//  Set callback called when a reply of asset agent changed resolved data
+//  or a request was given up
+FTY_INFO_PRIVATE void
+    topologyresolver_set_callback (topologyresolver_t *self, topologyresolver_fn *callback, void *arg);
+
+//  Return socket which becomes readable when asset agent replies
+FTY_INFO_PRIVATE zsock_t *
+    topologyresolver_msgpipe (topologyresolver_t *self);
+
+//  Process one reply of asset agent, call it when msgpipe is readable
+FTY_INFO_PRIVATE void
+    topologyresolver_recv (topologyresolver_t *self);
+
+//  Return ms until some pending request times out, -1 if there is none
+FTY_INFO_PRIVATE int
+    topologyresolver_timeout (topologyresolver_t *self, int64_t now);
+
+//  Resend requests which timed out, or give them up after few attempts
+FTY_INFO_PRIVATE void
+    topologyresolver_expire (topologyresolver_t *self, int64_t now);
+
 //  get RC internal name
 FTY_INFO_PRIVATE char *
     topologyresolver_id (topologyresolver_t *self);
@@ -47,10 +85,24 @@ FTY_INFO_PRIVATE char *
 FTY_INFO_PRIVATE char *
     topologyresolver_to_rc_name_uri (topologyresolver_t *self);
 
+//  Set registry of local addresses used to recognize own asset, it is not
+//  owned by resolver. Without it, addresses are read for every candidate.
+FTY_INFO_PRIVATE void
+    topologyresolver_set_localaddrs (topologyresolver_t *self, localaddrs_t *addrs);
+
 //  Give topology resolver one asset information
 FTY_INFO_PRIVATE bool
     topologyresolver_asset (topologyresolver_t *self, fty_proto_t *message);
 
+//  Return false if asset message can't change anything, decided from its
+//  iname and operation (NULL if unknown) before the message is decoded
+FTY_INFO_PRIVATE bool
+    topologyresolver_wants (topologyresolver_t *self, const char *iname, const char *operation);
+
+//  Return version of resolved data, it changes whenever data can change
+FTY_INFO_PRIVATE uint64_t
+    topologyresolver_version (topologyresolver_t *self);
+
 //  Return URI of the asset's parent
 FTY_INFO_PRIVATE char *
     topologyresolver_to_parent_uri (topologyresolver_t *self);
@@ -72,7 +124,8 @@ FTY_INFO_PRIVATE char *
     topologyresolver_to_string (topologyresolver_t *self, const char *separator = "/");
 
 //  Return zlist of inames starting with asset up to DC
-//  Empty list is returned if the topology is incomplete yet
+//  Empty list is returned if the topology is incomplete yet, missing parent
+//  is then requested from asset agent
 FTY_INFO_PRIVATE zlistx_t *
     topologyresolver_to_list (topologyresolver_t *self);
 